@@ -0,0 +1,189 @@
+// Benchmark de reservas de memoria en el camino de los mensajes.
+// Reemplaza el operator new global para contar reservas y compara, en estado estable:
+//   - el mensaje anterior (std::vector<uint8_t> data, copiado en cada etapa)
+//   - el Message actual (Payload embebido, entregado por movimiento)
+// Cada "mensaje" recorre: envío al árbitro, arbitraje, acceso a memoria, respuesta,
+// cola de respuestas del PE y escritura/lectura en la caché.
+// Además mide una Simulation::run() completa (kernel, interconnect y PEs): corre el mismo workload
+// con N y 2N instrucciones por PE y atribuye la diferencia de reservas a las N instrucciones extra,
+// así la preparación y el arranque (el warm-up) quedan fuera de la cuenta. Ahí solo se admite el
+// crecimiento amortizado de algunos buffers (histogramas, buffer del hilo de trazas): ninguna
+// reserva por evento, mensaje o instrucción.
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <new>
+#include <queue>
+#include <vector>
+#include "Arbiter.hpp"
+#include "Cache.hpp"
+#include "MainMemory.hpp"
+#include "Message.hpp"
+#include "Simulation.hpp"
+#include "SpscQueue.hpp"
+
+static std::atomic<uint64_t> allocationCount{0};
+
+void* operator new(std::size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+namespace {
+
+constexpr uint64_t WARMUP = 10'000;
+constexpr uint64_t MESSAGES = 1'000'000;
+
+// Representación anterior del mensaje (carga útil en el heap)
+struct LegacyMessage {
+    MessageType type = MessageType::READ_MEM;
+    uint16_t src = 0;
+    uint16_t dest = 0;
+    uint32_t addr = 0;
+    uint32_t size = 0;
+    std::vector<uint8_t> data;
+    uint8_t qos = 0;
+    uint64_t cycle = 0;
+};
+
+std::vector<uint8_t> legacyMemory(16 * 1024, 0);
+
+// Un mensaje con el esquema anterior: copias por valor y vectores nuevos en cada etapa
+void legacyRoundTrip(uint32_t i, std::vector<LegacyMessage>& fifo, std::queue<LegacyMessage>& responses) {
+    LegacyMessage request;
+    request.type = (i & 1) ? MessageType::WRITE_MEM : MessageType::READ_MEM;
+    request.src = uint16_t(i % 8);
+    request.addr = (i * 16) % 8192;
+    request.size = 16;
+    if (request.type == MessageType::WRITE_MEM) request.data = std::vector<uint8_t>(16, uint8_t(i));
+
+    fifo.push_back(request);                       // sendMessage(const Message&)
+    LegacyMessage msg = fifo.front();              // msg = fifoMessageQueue.front()
+    fifo.erase(fifo.begin());
+
+    LegacyMessage response;
+    response.dest = msg.src;
+    response.addr = msg.addr;
+    if (msg.type == MessageType::READ_MEM) {
+        std::vector<uint8_t> data(legacyMemory.begin() + msg.addr, legacyMemory.begin() + msg.addr + msg.size); // MainMemory::read
+        response.data = data;
+    } else {
+        std::copy(msg.data.begin(), msg.data.end(), legacyMemory.begin() + msg.addr);
+    }
+
+    responses.push(response);                      // receiveResponse(const Message&)
+    LegacyMessage handled = responses.front();     // handleResponses
+    responses.pop();
+
+    std::vector<uint8_t> hit(handled.data.begin(), handled.data.end()); // readFromCache devolvía un vector nuevo
+    if (hit.size() == 99) std::cout << "";
+}
+
+// Un mensaje con el esquema actual
+void currentRoundTrip(uint32_t i, Arbiter& arbiter, MainMemory& memory, SpscQueue<Message>& responses, Cache& cache) {
+    Message request;
+    request.type = (i & 1) ? MessageType::WRITE_MEM : MessageType::READ_MEM;
+    request.src = uint16_t(i % 8);
+    request.addr = (i * 16) % 8192;
+    request.size = 16;
+    if (request.type == MessageType::WRITE_MEM) request.data.assign(16, uint8_t(i));
+
+    arbiter.push(std::move(request));              // sendMessage(Message&&)
+    Message msg = arbiter.pop();
+
+    Message response;
+    response.dest = msg.src;
+    response.addr = msg.addr;
+    if (msg.type == MessageType::READ_MEM) {
+        response.data.resize(msg.size);
+        memory.read(msg.addr, response.data.data(), response.data.size());
+    } else {
+        memory.write(msg.addr, msg.data.data(), msg.data.size());
+    }
+
+    responses.push(std::move(response));           // receiveResponse(Message&&)
+    Message handled = std::move(*responses.front()); // handleResponses
+    responses.pop();
+
+    CacheBlock& block = cache.allocate(handled.addr); // writeToCache
+    std::copy(handled.data.begin(), handled.data.end(), block.data.begin());
+    block.state = CoherenceState::SHARED;
+    CacheBlock* hit = cache.lookup(handled.addr);     // readFromCache (Payload devuelto por valor)
+    Payload result;
+    result.assign(hit->data.data(), 16);
+    if (result.size() == 99) std::cout << "";
+}
+
+template <typename Fn>
+double allocationsPerMessage(Fn roundTrip) {
+    for (uint32_t i = 0; i < WARMUP; ++i) roundTrip(i); // Las colas alcanzan su capacidad de estado estable
+    uint64_t before = allocationCount.load();
+    for (uint32_t i = 0; i < MESSAGES; ++i) roundTrip(i);
+    return double(allocationCount.load() - before) / double(MESSAGES);
+}
+
+// Reservas de memoria durante Simulation::run() de un workload sintético (sin prepare)
+uint64_t simulationAllocations(size_t instructions, int workerThreads, const std::string& outputDir) {
+    SimulationConfig config;
+    config.synthetic = true;
+    config.workload.pattern = TrafficPattern::STRIDED;
+    config.workload.instructions = instructions;
+    config.runMode = RunMode::BATCH;
+    config.workerThreads = workerThreads;
+    config.traceFormat = TraceFormat::BINARY;
+    config.outputDir = outputDir;
+
+    Simulation simulation(config);
+    if (!simulation.prepare()) std::exit(1);
+    uint64_t before = allocationCount.load();
+    simulation.run();
+    return allocationCount.load() - before;
+}
+
+// Reservas por instrucción en estado estable de una simulación completa
+double allocationsPerInstruction(int workerThreads, const std::string& outputDir) {
+    constexpr size_t INSTRUCTIONS = 20'000;
+    uint64_t base = simulationAllocations(INSTRUCTIONS, workerThreads, outputDir);
+    uint64_t doubled = simulationAllocations(2 * INSTRUCTIONS, workerThreads, outputDir);
+    uint64_t extra = doubled > base ? doubled - base : 0;
+    return double(extra) / double(INSTRUCTIONS * SimulationConfig().numPEs);
+}
+
+} // namespace
+
+int main() {
+    std::vector<LegacyMessage> legacyFifo;
+    std::queue<LegacyMessage> legacyResponses;
+    double legacy = allocationsPerMessage([&](uint32_t i) { legacyRoundTrip(i, legacyFifo, legacyResponses); });
+
+    MainMemory memory;
+    SpscQueue<Message> responses;
+    Cache cache;
+    FifoArbiter fifo;
+    double currentFifo = allocationsPerMessage([&](uint32_t i) { currentRoundTrip(i, fifo, memory, responses, cache); });
+    PriorityArbiter priority;
+    double currentPriority = allocationsPerMessage([&](uint32_t i) { currentRoundTrip(i, priority, memory, responses, cache); });
+
+    std::string outputDir = (std::filesystem::temp_directory_path() / "alloc_bench").string();
+    std::filesystem::create_directories(outputDir);
+    double simulationSerial = allocationsPerInstruction(1, outputDir);
+    double simulationParallel = allocationsPerInstruction(4, outputDir);
+    std::filesystem::remove_all(outputDir);
+
+    std::cout << "Reservas de memoria por mensaje (" << MESSAGES << " mensajes en estado estable):\n"
+              << "  esquema anterior (std::vector)   " << legacy << "\n"
+              << "  Payload embebido, árbitro FIFO   " << currentFifo << "\n"
+              << "  Payload embebido, árbitro QoS    " << currentPriority << "\n"
+              << "Reservas de memoria por instrucción en Simulation::run() (strided, trazas binarias):\n"
+              << "  1 hilo                           " << simulationSerial << "\n"
+              << "  4 hilos                          " << simulationParallel << "\n";
+
+    constexpr double AMORTIZED = 0.001; // Una reserva por evento daría del orden de 1 por instrucción
+    bool simulationOk = simulationSerial < AMORTIZED && simulationParallel < AMORTIZED;
+    return (currentFifo == 0.0 && currentPriority == 0.0 && simulationOk) ? 0 : 1;
+}
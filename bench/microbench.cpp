@@ -0,0 +1,315 @@
+// Suite de microbenchmarks del simulador sobre Google Benchmark (objetivo bench).
+//   - Interconnect::sendMessage con 1-64 hilos productores y vaciado de la cola del árbitro
+//   - PE::readFromCache / PE::writeToCache
+//   - MainMemory::read / MainMemory::write, y accesos concurrentes a bancos distintos o a uno solo
+//   - Simulación completa de workloads sintéticos (instrucciones simuladas por segundo)
+// Los resultados salen en JSON con --benchmark_format=json o --benchmark_out=<archivo>.
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "Interconnect.hpp"
+#include "MainMemory.hpp"
+#include "PE.hpp"
+#include "Simulator.hpp"
+#include "WorkloadGenerator.hpp"
+
+namespace {
+
+constexpr int MAX_PRODUCERS = 64;
+constexpr int64_t SEND_MESSAGES = 1 << 18;  // Mensajes por corrida de sendMessage (repartidos entre los hilos)
+constexpr int64_t DRAIN_MESSAGES = 4096;    // Mensajes en la cola antes de vaciarla
+constexpr uint32_t MEMORY_SIZE = 1 << 20;
+constexpr size_t WORKLOAD_INSTRUCTIONS = 1000; // Por PE
+
+// Simulador, interconnect y PEs sin programa (solo reciben respuestas)
+struct System {
+    System(int mode, int numPEs, CoherenceMode coherence = CoherenceMode::BROADCAST) {
+        interconnect = std::make_unique<Interconnect>(&simulator, mode);
+        interconnect->setCoherenceMode(coherence);
+        for (int i = 0; i < numPEs; i++) {
+            pes.push_back(std::make_unique<PE>(i, uint8_t(i), interconnect.get(), &simulator));
+            interconnect->registerPE(uint16_t(i), pes.back().get());
+        }
+    }
+
+    Simulator simulator;
+    std::unique_ptr<Interconnect> interconnect;
+    std::vector<std::unique_ptr<PE>> pes;
+};
+
+Message readRequest(uint16_t src, uint64_t n) {
+    Message msg;
+    msg.type = MessageType::READ_MEM;
+    msg.src = src;
+    msg.qos = uint8_t(src);
+    msg.addr = uint32_t((n * 16) & 0x3FF0);
+    msg.size = 4;
+    return msg;
+}
+
+// -------------------- Interconnect --------------------
+
+System* sendSystem = nullptr; // Compartido por los hilos de una corrida; lo crea y destruye el hilo 0
+
+// Envío concurrente: cada hilo es un PE distinto que encola solicitudes de lectura
+void BM_InterconnectSendMessage(benchmark::State& state) {
+    if (state.thread_index() == 0) {
+        sendSystem = new System(int(state.range(0)), MAX_PRODUCERS);
+    }
+    uint16_t src = uint16_t(state.thread_index() % MAX_PRODUCERS);
+    uint64_t n = 0;
+    for (auto _ : state) {
+        sendSystem->interconnect->sendMessage(readRequest(src, n++));
+    }
+    state.SetItemsProcessed(state.iterations());
+    if (state.thread_index() == 0) {
+        delete sendSystem; // Los mensajes encolados se descartan sin simularse
+        sendSystem = nullptr;
+    }
+}
+
+// Vaciado: la cola se llena con producers hilos concurrentes (fuera de la medición) y se mide
+// el servicio completo de todos los mensajes (arbitraje, memoria y entrega de la respuesta)
+void BM_InterconnectDrain(benchmark::State& state) {
+    int mode = int(state.range(0));
+    int producers = int(state.range(1));
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto system = std::make_unique<System>(mode, producers);
+        std::vector<std::thread> threads;
+        for (int p = 0; p < producers; p++) {
+            threads.emplace_back([&, p] {
+                for (int64_t n = p; n < DRAIN_MESSAGES; n += producers) {
+                    system->interconnect->sendMessage(readRequest(uint16_t(p), uint64_t(n)));
+                }
+            });
+        }
+        for (auto& thread : threads) thread.join();
+        state.ResumeTiming();
+
+        system->simulator.run();
+
+        state.PauseTiming();
+        system.reset();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * DRAIN_MESSAGES);
+}
+
+// -------------------- Caché del PE --------------------
+
+// Lecturas de 4 bytes que aciertan (range(1) = 1) o fallan siempre (range(1) = 0)
+void BM_PEReadFromCache(benchmark::State& state) {
+    CacheConfig config;
+    config.associativity = size_t(state.range(0));
+    System system(0, 0);
+    PE pe(0, 0, system.interconnect.get(), &system.simulator, config);
+
+    bool hits = state.range(1) != 0;
+    uint32_t lines = uint32_t(config.sizeBytes / config.lineSize);
+    if (hits) {
+        Payload line;
+        line.assign(config.lineSize, 0xAB);
+        for (uint32_t i = 0; i < lines; i++) pe.writeToCache(i * uint32_t(config.lineSize), line);
+    }
+    uint32_t base = hits ? 0 : uint32_t(config.sizeBytes); // Sin escrituras previas: todo falla
+
+    uint32_t i = 0;
+    for (auto _ : state) {
+        Payload data = pe.readFromCache(base + (i++ % lines) * uint32_t(config.lineSize), 4);
+        benchmark::DoNotOptimize(data);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// Escrituras de líneas completas sobre el doble de la capacidad (con reemplazos)
+void BM_PEWriteToCache(benchmark::State& state) {
+    CacheConfig config;
+    config.associativity = size_t(state.range(0));
+    System system(0, 0);
+    PE pe(0, 0, system.interconnect.get(), &system.simulator, config);
+
+    Payload line;
+    line.assign(config.lineSize, 0xCD);
+    uint32_t lines = uint32_t(2 * config.sizeBytes / config.lineSize);
+    uint32_t i = 0;
+    for (auto _ : state) {
+        pe.writeToCache((i++ % lines) * uint32_t(config.lineSize), line);
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * int64_t(config.lineSize));
+}
+
+// -------------------- Memoria principal --------------------
+
+// Direcciones pseudoaleatorias alineadas a size dentro de la memoria
+std::vector<uint32_t> memoryAddresses(size_t size) {
+    std::vector<uint32_t> addrs(4096);
+    uint64_t x = 0x9E3779B97F4A7C15ull;
+    for (uint32_t& addr : addrs) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        addr = uint32_t(x % (MEMORY_SIZE / size) * size);
+    }
+    return addrs;
+}
+
+MemoryConfig benchMemory() {
+    MemoryConfig config;
+    config.sizeBytes = MEMORY_SIZE;
+    config.banks = 8;
+    return config;
+}
+
+void BM_MainMemoryRead(benchmark::State& state) {
+    size_t size = size_t(state.range(0));
+    MainMemory memory;
+    memory.configure(benchMemory());
+    std::vector<uint8_t> buffer(size, 0x5A);
+    for (uint32_t addr = 0; addr < MEMORY_SIZE; addr += uint32_t(size)) memory.write(addr, buffer.data(), size); // Páginas ya asignadas
+    std::vector<uint32_t> addrs = memoryAddresses(size);
+
+    size_t i = 0;
+    for (auto _ : state) {
+        memory.read(addrs[i++ & (addrs.size() - 1)], buffer.data(), size);
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * int64_t(size));
+}
+
+void BM_MainMemoryWrite(benchmark::State& state) {
+    size_t size = size_t(state.range(0));
+    MainMemory memory;
+    memory.configure(benchMemory());
+    std::vector<uint8_t> buffer(size, 0xA5);
+    std::vector<uint32_t> addrs = memoryAddresses(size);
+
+    size_t i = 0;
+    for (auto _ : state) {
+        memory.write(addrs[i++ & (addrs.size() - 1)], buffer.data(), size);
+    }
+    state.SetBytesProcessed(state.iterations() * int64_t(size));
+}
+
+MainMemory* bankMemory = nullptr; // Compartida por los hilos de una corrida; la crea y destruye el hilo 0
+
+// Accesos concurrentes de 64 bytes (un tramo de entrelazado): con range(0) = 1 cada hilo usa su propio
+// banco y los locks no se cruzan; con 0 todos usan el banco 0 y se serializan en su lock
+void BM_MainMemoryBanks(benchmark::State& state) {
+    MemoryConfig config = benchMemory();
+    uint32_t interleave = uint32_t(config.interleaveBytes);
+    uint32_t stride = interleave * uint32_t(config.banks); // Siguiente tramo del mismo banco
+    if (state.thread_index() == 0) {
+        bankMemory = new MainMemory;
+        bankMemory->configure(config);
+        std::vector<uint8_t> zeros(MEMORY_SIZE, 0);
+        bankMemory->write(0, zeros.data(), zeros.size()); // Páginas ya asignadas
+    }
+    uint32_t bank = state.range(0) ? uint32_t(state.thread_index()) % uint32_t(config.banks) : 0;
+    std::vector<uint8_t> buffer(interleave, uint8_t(state.thread_index()));
+
+    uint32_t addr = bank * interleave;
+    for (auto _ : state) {
+        bankMemory->write(addr, buffer.data(), buffer.size());
+        bankMemory->read(addr, buffer.data(), buffer.size());
+        addr = (addr + stride) & (MEMORY_SIZE - 1);
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * int64_t(2 * buffer.size()));
+    if (state.thread_index() == 0) {
+        delete bankMemory;
+        bankMemory = nullptr;
+    }
+}
+
+// -------------------- Simulación completa --------------------
+
+// Workload sintético de principio a fin (sin trazas): range(0) patrón, range(1) PEs, range(2) directorio
+void BM_SimulateWorkload(benchmark::State& state) {
+    WorkloadConfig workload;
+    workload.pattern = TrafficPattern(state.range(0));
+    workload.instructions = WORKLOAD_INSTRUCTIONS;
+    int numPEs = int(state.range(1));
+    CoherenceMode coherence = state.range(2) ? CoherenceMode::DIRECTORY : CoherenceMode::BROADCAST;
+    state.SetLabel(trafficPatternName(workload.pattern));
+
+    std::vector<std::shared_ptr<const InstructionStream>> programs;
+    for (int i = 0; i < numPEs; i++) {
+        programs.push_back(std::make_shared<InstructionStream>(generateWorkload(workload, uint16_t(i), uint16_t(numPEs))));
+    }
+
+    uint64_t cycles = 0;
+    for (auto _ : state) {
+        state.PauseTiming();
+        Simulator simulator;
+        Interconnect interconnect(&simulator);
+        interconnect.setCoherenceMode(coherence);
+        std::vector<std::unique_ptr<PE>> pes;
+        for (int i = 0; i < numPEs; i++) {
+            pes.push_back(std::make_unique<PE>(i, uint8_t(i), &interconnect, &simulator));
+            interconnect.registerPE(uint16_t(i), pes.back().get());
+            pes.back()->setProgram(programs[size_t(i)]);
+        }
+        for (auto& pe : pes) pe->start();
+        state.ResumeTiming();
+
+        simulator.run();
+
+        state.PauseTiming();
+        cycles = simulator.now();
+        pes.clear();
+        state.ResumeTiming();
+    }
+    int64_t instructions = int64_t(WORKLOAD_INSTRUCTIONS) * numPEs;
+    state.SetItemsProcessed(state.iterations() * instructions); // items_per_second = instrucciones simuladas por segundo
+    state.counters["sim_cycles"] = double(cycles);
+    state.counters["sim_cycles_per_s"] = benchmark::Counter(double(cycles) * double(state.iterations()), benchmark::Counter::kIsRate);
+}
+
+void registerBenchmarks() {
+    // Iteraciones fijas por hilo para que la cola no crezca sin límite con muchos productores
+    for (int mode = 0; mode <= 4; mode++) {
+        for (int threads = 1; threads <= MAX_PRODUCERS; threads *= 2) {
+            benchmark::RegisterBenchmark("BM_InterconnectSendMessage", BM_InterconnectSendMessage)
+                ->ArgName("mode")->Arg(mode)->Threads(threads)->Iterations(SEND_MESSAGES / threads)->UseRealTime();
+        }
+    }
+    benchmark::RegisterBenchmark("BM_InterconnectDrain", BM_InterconnectDrain)
+        ->ArgNames({"mode", "producers"})
+        ->ArgsProduct({{0, 1, 2, 3, 4}, {1, 8, 64}})
+        ->Unit(benchmark::kMicrosecond);
+
+    benchmark::RegisterBenchmark("BM_PEReadFromCache", BM_PEReadFromCache)
+        ->ArgNames({"ways", "hit"})
+        ->ArgsProduct({{1, 4, 8}, {0, 1}});
+    benchmark::RegisterBenchmark("BM_PEWriteToCache", BM_PEWriteToCache)
+        ->ArgName("ways")->Arg(1)->Arg(4)->Arg(8);
+
+    benchmark::RegisterBenchmark("BM_MainMemoryRead", BM_MainMemoryRead)
+        ->ArgName("bytes")->Arg(4)->Arg(16)->Arg(64);
+    benchmark::RegisterBenchmark("BM_MainMemoryWrite", BM_MainMemoryWrite)
+        ->ArgName("bytes")->Arg(4)->Arg(16)->Arg(64);
+    for (int threads = 1; threads <= 8; threads *= 2) {
+        benchmark::RegisterBenchmark("BM_MainMemoryBanks", BM_MainMemoryBanks)
+            ->ArgName("own_bank")->Arg(0)->Arg(1)->Threads(threads)->UseRealTime();
+    }
+
+    benchmark::RegisterBenchmark("BM_SimulateWorkload", BM_SimulateWorkload)
+        ->ArgNames({"pattern", "pes", "directory"})
+        ->ArgsProduct({{0, 1, 2, 3, 4}, {8, 64}, {0, 1}})
+        ->Unit(benchmark::kMillisecond);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    registerBenchmarks();
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
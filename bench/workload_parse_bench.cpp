@@ -0,0 +1,91 @@
+// Benchmark de carga de workloads: 2M instrucciones en un archivo temporal.
+// Compara el esquema anterior (std::getline a un vector de strings y, en cada ejecución,
+// istringstream + comparación de strings + std::stoul) contra InstructionStream (mmap y
+// decodificación única a struct-of-arrays, sin strings en el ciclo de ejecución).
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "InstructionStream.hpp"
+
+namespace {
+
+constexpr size_t INSTRUCTIONS = 2'000'000;
+
+void writeWorkload(const std::string& path) {
+    std::ofstream file(path);
+    char line[64];
+    for (size_t i = 0; i < INSTRUCTIONS; ++i) {
+        uint32_t addr = uint32_t((i * 0x10) & 0x3FF0);
+        switch (i % 3) {
+            case 0: std::snprintf(line, sizeof(line), "READ_MEM 0x%03X %zu\n", addr, 4 + i % 13); break;
+            case 1: std::snprintf(line, sizeof(line), "WRITE_MEM 0x%03X %zu\n", addr, 1 + i % 4); break;
+            default: std::snprintf(line, sizeof(line), "BROADCAST_INVALIDATE 0x%03X\n", addr); break;
+        }
+        file << line;
+    }
+}
+
+double msSince(std::chrono::steady_clock::time_point begin) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+}
+
+} // namespace
+
+int main() {
+    std::string path = (std::filesystem::temp_directory_path() / "workload_parse_bench.txt").string();
+    writeWorkload(path);
+
+    // Esquema anterior: carga de líneas y decodificación en cada ejecución
+    auto begin = std::chrono::steady_clock::now();
+    std::vector<std::string> lines;
+    {
+        std::ifstream file(path);
+        std::string line;
+        while (std::getline(file, line)) lines.push_back(line);
+    }
+    double legacyLoad = msSince(begin);
+
+    begin = std::chrono::steady_clock::now();
+    uint64_t legacySum = 0;
+    for (const std::string& instruction : lines) {
+        std::istringstream iss(instruction);
+        std::string opcode, addrText;
+        size_t operand = 0;
+        iss >> opcode >> addrText;
+        if (opcode == "READ_MEM" || opcode == "WRITE_MEM") iss >> operand;
+        legacySum += std::stoul(addrText, nullptr, 16) + operand + opcode.size();
+    }
+    double legacyDecode = msSince(begin);
+
+    // InstructionStream: mmap + parser manual, una sola vez
+    begin = std::chrono::steady_clock::now();
+    InstructionStream stream;
+    stream.load(path);
+    double streamLoad = msSince(begin);
+
+    begin = std::chrono::steady_clock::now();
+    uint64_t streamSum = 0;
+    for (size_t i = 0; i < stream.size(); ++i) {
+        streamSum += stream.addr(i) + stream.operand(i) + std::char_traits<char>::length(opcodeName(stream.opcode(i)));
+    }
+    double streamDecode = msSince(begin);
+
+    std::filesystem::remove(path);
+
+    std::cout << INSTRUCTIONS << " instrucciones:\n"
+              << "  getline + istringstream   carga " << legacyLoad << " ms, decodificación por ejecución " << legacyDecode << " ms\n"
+              << "  InstructionStream (mmap)  carga " << streamLoad << " ms, lectura por ejecución " << streamDecode << " ms\n"
+              << "  aceleración de carga+decodificación " << (legacyLoad + legacyDecode) / streamLoad << "x\n";
+
+    if (legacySum != streamSum || stream.size() != INSTRUCTIONS) {
+        std::cerr << "Error: los resultados no coinciden\n";
+        return 1;
+    }
+    return 0;
+}
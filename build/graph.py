@@ -1,13 +1,45 @@
 # script para generar gráficas del interconnect y PEs
 import os
+import numpy as np
 import pandas as pd
 import matplotlib.pyplot as plt
 
 # ruta de la carpeta con los archivos
 folderPath = os.path.abspath(os.path.join(os.path.dirname(__file__), "..", "output"))
 
+# nombres de las instrucciones según el opcode de la traza binaria (orden de MessageType)
+opNames = ["READ_MEM", "WRITE_MEM", "BROADCAST_INVALIDATE", "INV_ACK", "INV_COMPLETE", "READ_RESP", "WRITE_RESP"]
+
+# registro de 24 bytes de la traza binaria (ver TraceRecord.hpp), después de un encabezado de 16 bytes
+traceRecord = np.dtype([("cycle", "<u8"), ("addr", "<u4"), ("size", "<u2"), ("peer", "<u2"),
+                        ("op", "u1"), ("recvSend", "u1"), ("peerKind", "u1"), ("reserved", "V5")])
+
+# se usa el formato escrito por la última simulación (--trace=text|binary)
+def pickExtension():
+    txt = os.path.join(folderPath, "intconnect.txt")
+    bin = os.path.join(folderPath, "intconnect.bin")
+    if os.path.exists(bin) and (not os.path.exists(txt) or os.path.getmtime(bin) >= os.path.getmtime(txt)):
+        return ".bin"
+    return ".txt"
+
+# función para cargar logs binarios: sin parsear texto, se lee el archivo como arreglo
+def loadBinaryLogs(filePath):
+    records = np.fromfile(filePath, dtype=traceRecord, offset=16)
+    instr = np.array(opNames + ["UNKNOWN"] * (256 - len(opNames)))[records["op"]]
+    srcDst = np.where(records["peerKind"] == 0, np.char.add("P", records["peer"].astype(str)),
+                      np.where(records["peerKind"] == 1, "IC", "All"))
+    return pd.DataFrame({
+        "instr": instr,
+        "recvSend": records["recvSend"].astype(int),
+        "size": records["size"].astype(int),
+        "srcDst": srcDst,
+        "cycle": records["cycle"].astype(np.int64)
+    })
+
 # función para cargar logs
 def loadLogs(filePath):
+    if filePath.endswith(".bin"):
+        return loadBinaryLogs(filePath)
     with open(filePath, 'r') as f:
         lines = f.readlines()[1:]  # saltar encabezado
     data = []
@@ -25,8 +57,12 @@ def loadLogs(filePath):
     return pd.DataFrame(data)
 
 # cargar interconnect y PEs
-interconnect = loadLogs(os.path.join(folderPath, "intconnect.txt"))
-pes = [loadLogs(os.path.join(folderPath, f"pe{i}.txt")) for i in range(8)]
+ext = pickExtension()
+interconnect = loadLogs(os.path.join(folderPath, "intconnect" + ext))
+numPEs = 0
+while os.path.exists(os.path.join(folderPath, f"pe{numPEs}{ext}")):
+    numPEs += 1
+pes = [loadLogs(os.path.join(folderPath, f"pe{i}{ext}")) for i in range(numPEs)]
 
 # --- Gráfica 1: Ancho de banda por ciclo en interconnect ---
 bw = interconnect.groupby("cycle")["size"].sum()
@@ -0,0 +1,134 @@
+#ifndef ARBITER_HPP
+#define ARBITER_HPP
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "Message.hpp"
+#include "RingQueue.hpp"
+
+class CheckpointReader;
+class CheckpointWriter;
+
+// Política de arbitraje del Interconnect: decide qué mensaje pendiente usa el bus a continuación
+class Arbiter {
+public:
+    virtual ~Arbiter() = default;
+    virtual void push(const Message& msg) = 0;
+    virtual void push(Message&& msg) = 0;
+    virtual Message pop() = 0;          // Extrae el siguiente mensaje según la política
+    virtual bool empty() const = 0;
+    virtual size_t size() const = 0;
+
+    // Checkpoint: mensajes en espera y estado de la política (se restaura sobre un árbitro vacío del mismo modo)
+    virtual void saveState(CheckpointWriter& out) const = 0;
+    virtual void loadState(CheckpointReader& in) = 0;
+};
+
+// Modo FIFO: los mensajes usan el bus en orden de llegada (cola circular, pop O(1))
+class FifoArbiter : public Arbiter {
+public:
+    void push(const Message& msg) override;
+    void push(Message&& msg) override;
+    Message pop() override;
+    bool empty() const override;
+    size_t size() const override;
+    void saveState(CheckpointWriter& out) const override;
+    void loadState(CheckpointReader& in) override;
+
+private:
+    RingQueue<Message> fifoMessageQueue;
+};
+
+// Mensaje en espera con su clave de prioridad; seq desempata en orden de llegada
+struct PrioritizedMessage {
+    uint64_t key;
+    uint64_t seq;
+    Message msg;
+};
+
+// Estructura para comparar mensajes por clave de prioridad (min-heap)
+struct CompareMessages {
+    bool operator()(const PrioritizedMessage& a, const PrioritizedMessage& b) const {
+        if (a.key != b.key) return a.key > b.key;
+        return a.seq > b.seq;
+    }
+};
+
+// Modo Prioridad: el mensaje con menor valor de QoS usa el bus primero; a igual QoS, el más antiguo.
+// Con envejecimiento (agingGrants > 0) un mensaje mejora un nivel de QoS por cada agingGrants
+// concesiones que espera: la clave qos * agingGrants + concesiones al llegar no cambia con el tiempo,
+// así el heap sigue siendo válido y ningún PE queda postergado indefinidamente.
+class PriorityArbiter : public Arbiter {
+public:
+    explicit PriorityArbiter(uint64_t agingGrants = 0);
+    void push(const Message& msg) override;
+    void push(Message&& msg) override;
+    Message pop() override;
+    bool empty() const override;
+    size_t size() const override;
+    void saveState(CheckpointWriter& out) const override;
+    void loadState(CheckpointReader& in) override;
+
+private:
+    uint64_t agingGrants;
+    uint64_t grants = 0;  // Mensajes concedidos hasta ahora
+    uint64_t nextSeq = 0;
+    std::vector<PrioritizedMessage> priorityMessageQueue; // Heap ordenado por CompareMessages
+};
+
+// Colas por PE de origen atendidas por turnos (base de WRR y DRR).
+// El peso de un PE depende de su QoS: max(1, MAX_WEIGHT - qos).
+class RoundRobinArbiter : public Arbiter {
+public:
+    static constexpr uint64_t MAX_WEIGHT = 8;
+
+    void push(const Message& msg) override;
+    void push(Message&& msg) override;
+    bool empty() const override;
+    size_t size() const override;
+    void saveState(CheckpointWriter& out) const override;
+    void loadState(CheckpointReader& in) override;
+
+protected:
+    struct Flow {
+        RingQueue<Message> queue{4};
+        uint64_t credit = 0;  // Mensajes (WRR) o bytes (DRR) disponibles en el turno
+        bool inTurn = false;  // El turno actual ya sumó su crédito
+        bool active = false;  // Está en la ronda de turnos
+    };
+
+    static uint64_t weight(uint8_t qos);
+    Flow& flowOf(uint16_t src);
+    Message take(uint16_t id);  // Extrae el frente de la cola; si queda vacía sale de la ronda
+    void rotate();              // El PE del turno pasa al final de la ronda
+
+    std::vector<Flow> flows;     // Indexado por ID de PE
+    RingQueue<uint16_t> round;   // PEs con mensajes, en orden de turno
+    size_t count = 0;
+};
+
+// Weighted round-robin: en cada turno un PE envía hasta peso mensajes
+class WeightedRoundRobinArbiter : public RoundRobinArbiter {
+public:
+    Message pop() override;
+};
+
+// Deficit round-robin: en cada turno un PE acumula peso * DRR_QUANTUM bytes de crédito y envía
+// mientras el mensaje del frente quepa; reparte ancho de banda en bytes y no en mensajes
+class DeficitRoundRobinArbiter : public RoundRobinArbiter {
+public:
+    static constexpr uint64_t DRR_QUANTUM = 8;
+
+    Message pop() override;
+};
+
+// Concesiones de espera por nivel de QoS ganado en el modo Prioridad con envejecimiento
+constexpr uint64_t AGING_GRANTS = 4;
+
+// Crea el árbitro correspondiente al modo de ejecución
+// (0 -> FIFO, 1 -> Prioridad, 2 -> WRR, 3 -> DRR, 4 -> Prioridad con envejecimiento)
+std::unique_ptr<Arbiter> makeArbiter(int executionMode);
+const char* arbiterName(int executionMode);
+
+#endif // ARBITER_HPP
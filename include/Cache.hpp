@@ -0,0 +1,89 @@
+#ifndef CACHE_HPP
+#define CACHE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "CacheBlock.hpp"
+
+class CheckpointReader;
+class CheckpointWriter;
+
+// Políticas de reemplazo dentro de un conjunto
+enum class ReplacementPolicy {
+    LRU,    // Menos recientemente usado (marca de tiempo por vía)
+    PLRU,   // Pseudo-LRU de árbol (asociatividad-1 bits por conjunto)
+    RANDOM  // Víctima pseudoaleatoria con semilla fija (determinista)
+};
+
+// Cuándo llegan a memoria las escrituras (sin protocolo de coherencia)
+enum class WritePolicy {
+    WRITE_THROUGH, // Cada WRITE_MEM actualiza la caché y se envía al interconnect
+    WRITE_BACK     // La línea queda sucia y se escribe al reemplazarla o al invalidarla
+};
+
+// Geometría de la caché de un PE. Por defecto: 128 líneas de 16 bytes, mapeo directo.
+struct CacheConfig {
+    size_t sizeBytes = 2048;
+    size_t associativity = 1;
+    size_t lineSize = 16;
+    ReplacementPolicy policy = ReplacementPolicy::LRU;
+    WritePolicy writePolicy = WritePolicy::WRITE_THROUGH;
+};
+
+// Devuelve un mensaje de error si la geometría no es válida, o un string vacío si lo es
+std::string cacheConfigError(const CacheConfig& config);
+
+// Convierte "lru" / "plru" / "random" a la política correspondiente
+bool parseReplacementPolicy(const std::string& text, ReplacementPolicy& policy);
+
+// Convierte "through" / "back" a la política de escritura correspondiente
+bool parseWritePolicy(const std::string& text, WritePolicy& policy);
+
+// Caché asociativa por conjuntos de N vías
+class Cache {
+public:
+    explicit Cache(const CacheConfig& config = {}, uint32_t seed = 1);
+
+    CacheBlock* lookup(uint32_t addr);   // Hit → bloque (actualiza el estado de reemplazo); miss → nullptr
+    CacheBlock* probe(uint32_t addr);    // Como lookup pero sin afectar el reemplazo (consultas de coherencia)
+    CacheBlock& allocate(uint32_t addr); // Bloque para la línea de addr: el existente o una víctima reinicializada
+    CacheBlock& allocate(uint32_t addr, CacheBlock& evicted); // Además copia en evicted la víctima válida reemplazada
+    bool invalidate(uint32_t addr);      // true si la línea estaba presente y válida
+
+    uint32_t lineOf(uint32_t addr) const;   // Número de línea (se usa como etiqueta)
+    uint32_t offsetOf(uint32_t addr) const; // Desplazamiento dentro de la línea
+    size_t setOf(uint32_t addr) const;      // Índice del conjunto
+
+    const CacheConfig& getConfig() const;
+    size_t getNumSets() const;
+
+    // Checkpoint: bloques (los datos solo de los válidos) y estado de reemplazo; la geometría debe coincidir
+    void saveState(CheckpointWriter& out) const;
+    void loadState(CheckpointReader& in);
+
+    // Recorre los bloques válidos: visit(bloque)
+    template <typename Visit>
+    void forEachValid(Visit visit) {
+        for (CacheBlock& block : blocks) {
+            if (block.valid()) visit(block);
+        }
+    }
+
+private:
+    CacheBlock* find(size_t set, uint32_t tag, size_t& way);
+    void touch(size_t set, size_t way); // Registra un uso para la política de reemplazo
+    size_t victim(size_t set);          // Vía a reemplazar en el conjunto
+
+    CacheConfig config;
+    size_t numSets;
+    uint32_t lineShift;                 // log2(tamaño de línea)
+    std::vector<CacheBlock> blocks;     // numSets * associativity, conjunto por conjunto
+    std::vector<uint64_t> lastUse;      // LRU: último uso de cada vía
+    std::vector<uint64_t> plruBits;     // PLRU: bits del árbol por conjunto
+    uint64_t useCounter = 0;
+    uint64_t rngState;                  // RANDOM: estado del xorshift
+};
+
+#endif // CACHE_HPP
@@ -3,11 +3,30 @@
 
 #include <array>
 #include <cstdint>
+#include "Coherence.hpp"
 
 struct CacheBlock {
-    uint32_t tag = 0;
-    std::array<uint8_t, 16> data = {};
-    bool valid = false;
+    static constexpr uint32_t MAX_LINE_SIZE = 64; // Tamaño máximo de línea configurable
+
+    uint32_t tag = 0;                             // Número de línea (addr / tamaño de línea)
+    std::array<uint8_t, MAX_LINE_SIZE> data = {};
+    CoherenceState state = CoherenceState::INVALID;
+    uint64_t readyCycle = 0; // Con protocolo: ciclo en que llega la respuesta que la instaló
+    uint64_t dirtyMask = 0;  // Write-back sin protocolo: bit i → byte i modificado (solo esos se escriben)
+
+    bool valid() const { return state != CoherenceState::INVALID; }
 };
 
+// Recorre los tramos contiguos de bits en 1 de una máscara de bytes: visit(desplazamiento, cantidad)
+template <typename Visit>
+void forEachByteRun(uint64_t mask, Visit visit) {
+    while (mask) {
+        uint32_t start = uint32_t(__builtin_ctzll(mask));
+        uint64_t run = mask >> start;
+        uint32_t length = ~run ? uint32_t(__builtin_ctzll(~run)) : 64 - start;
+        visit(start, length);
+        mask &= start + length >= 64 ? 0 : ~uint64_t(0) << (start + length);
+    }
+}
+
 #endif // CACHEBLOCK_HPP
@@ -0,0 +1,96 @@
+#ifndef CHECKPOINT_HPP
+#define CHECKPOINT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "Message.hpp"
+
+// Encabezado de los archivos de checkpoint, seguido del estado de cada componente en un orden fijo
+// (ver Simulation::saveCheckpoint). Los valores van en el orden de bytes del host, como las trazas .bin.
+struct CheckpointHeader {
+    char magic[8] = {'I', 'C', 'C', 'K', 'P', 'T', '\0', '\0'};
+    uint32_t version = 2;
+    uint32_t reserved = 0;
+};
+
+static_assert(sizeof(CheckpointHeader) == 16);
+
+// Acumula el estado serializado en memoria y lo escribe de una vez
+class CheckpointWriter {
+public:
+    template <typename T>
+    void put(const T& value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        putBytes(&value, sizeof(T));
+    }
+
+    // Cantidad de elementos seguida de los elementos (solo tipos sin relleno)
+    template <typename T>
+    void putVector(const std::vector<T>& values) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        put<uint64_t>(values.size());
+        putBytes(values.data(), values.size() * sizeof(T));
+    }
+
+    void putBytes(const void* data, size_t size);
+    void putString(const std::string& text);
+    void putMessage(const Message& msg); // Solo los bytes usados de la carga útil
+
+    bool save(const std::string& path) const; // false (con el error en std::cerr) si no se pudo escribir
+    size_t size() const;                      // Bytes sin el encabezado
+
+private:
+    std::vector<uint8_t> buffer;
+};
+
+// Lee un checkpoint completo y lo recorre en el mismo orden en que se escribió. Una lectura más allá
+// del final (o un valor fuera de rango informado con fail) deja al lector en error: los valores
+// siguientes se leen como ceros y ok() devuelve false.
+class CheckpointReader {
+public:
+    bool load(const std::string& path); // false (con el error en std::cerr) si no es un checkpoint válido
+
+    template <typename T>
+    void get(T& value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        getBytes(&value, sizeof(T));
+    }
+
+    template <typename T>
+    T get() {
+        T value{};
+        get(value);
+        return value;
+    }
+
+    template <typename T>
+    void getVector(std::vector<T>& values) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        uint64_t count = get<uint64_t>();
+        if (count > remaining() / sizeof(T)) {
+            fail();
+            return;
+        }
+        values.resize(count);
+        getBytes(values.data(), count * sizeof(T));
+    }
+
+    void getBytes(void* data, size_t size);
+    void getString(std::string& text);
+    void getMessage(Message& msg);
+
+    void fail();             // Marca el checkpoint como inconsistente
+    bool ok() const;
+    bool atEnd() const;      // Se leyeron todos los bytes
+    size_t remaining() const;
+
+private:
+    std::vector<uint8_t> buffer;
+    size_t position = 0;
+    bool failed = false;
+};
+
+#endif // CHECKPOINT_HPP
@@ -0,0 +1,32 @@
+#ifndef COHERENCE_HPP
+#define COHERENCE_HPP
+
+#include <cstdint>
+#include <string>
+
+// Protocolo de coherencia de las cachés de los PEs
+enum class CoherenceProtocol {
+    NONE,  // Write-through con invalidaciones manuales (BROADCAST_INVALIDATE en el workload)
+    MESI,  // Write-back; las escrituras invalidan automáticamente las demás copias
+    MOESI  // MESI + estado OWNED: una línea modificada se comparte sin escribirla en memoria
+};
+
+// Estado de una línea de caché. Sin protocolo, una línea válida queda en SHARED (o en MODIFIED si
+// está sucia con la política write-back).
+enum class CoherenceState : uint8_t {
+    INVALID,
+    SHARED,    // Limpia, puede haber otras copias
+    EXCLUSIVE, // Limpia y única copia: se escribe sin avisar al interconnect
+    OWNED,     // Modificada y compartida (MOESI): esta caché responde por la línea
+    MODIFIED   // Modificada y única copia
+};
+
+bool parseCoherenceProtocol(const std::string& text, CoherenceProtocol& protocol); // "none" | "mesi" | "moesi"
+const char* coherenceProtocolName(CoherenceProtocol protocol);
+
+// La línea tiene datos más nuevos que la memoria: hay que escribirla al reemplazarla
+inline bool isDirty(CoherenceState state) {
+    return state == CoherenceState::MODIFIED || state == CoherenceState::OWNED;
+}
+
+#endif // COHERENCE_HPP
@@ -0,0 +1,50 @@
+#ifndef INSTRUCTIONSTREAM_HPP
+#define INSTRUCTIONSTREAM_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Código de operación de una instrucción de workload
+enum class Opcode : uint8_t {
+    READ_MEM,             // READ_MEM <addr hex> <bytes>
+    WRITE_MEM,            // WRITE_MEM <addr hex> <líneas>
+    BROADCAST_INVALIDATE, // BROADCAST_INVALIDATE <addr hex>
+    UNKNOWN               // Línea que no se pudo decodificar
+};
+
+const char* opcodeName(Opcode op);
+
+// Programa de un PE decodificado una sola vez al cargarlo, en forma struct-of-arrays
+// (opcode, dirección y operando en arreglos separados, 9 bytes por instrucción). El ciclo de
+// ejecución solo lee enteros. Varios PEs con el mismo workload pueden compartir el mismo stream.
+class InstructionStream {
+public:
+    // Mapea el archivo con mmap y lo decodifica; false si no se pudo abrir
+    bool load(const std::string& path);
+    // Decodifica texto ya en memoria (una instrucción por línea)
+    void parse(const char* begin, const char* end);
+    // Agrega una instrucción ya decodificada (generadores sintéticos)
+    void append(Opcode op, uint32_t addr, uint32_t operand);
+    void reserve(size_t instructions);
+
+    size_t size() const { return opcodes.size(); }
+    bool empty() const { return opcodes.empty(); }
+
+    Opcode opcode(size_t i) const { return opcodes[i]; }
+    uint32_t addr(size_t i) const { return addrs[i]; }
+    uint32_t operand(size_t i) const { return operands[i]; } // Bytes (READ_MEM) o líneas (WRITE_MEM)
+
+    std::string text(size_t i) const; // Instrucción en texto (para la consola)
+
+private:
+    void decodeLine(const char* begin, const char* end);
+
+    std::vector<Opcode> opcodes;
+    std::vector<uint32_t> addrs;     // En UNKNOWN: índice en unknownLines
+    std::vector<uint32_t> operands;
+    std::vector<std::string> unknownLines; // Texto original de las líneas no decodificadas
+};
+
+#endif // INSTRUCTIONSTREAM_HPP
@@ -1,55 +1,187 @@
 #ifndef INTERCONNECT_HPP
 #define INTERCONNECT_HPP
 
-#include <queue>
+#include <cstdint>
+#include <memory>
 #include <mutex>
-#include <condition_variable>
-#include <thread>
-#include <vector>          // Para usar std::vector en la cola FIFO
-#include <unordered_map>
+#include <string>
+#include <vector>
+#include "Arbiter.hpp"
+#include "Coherence.hpp"
+#include "LatencyHistogram.hpp"
 #include "Message.hpp"
 #include "PE.hpp"
 #include "MainMemory.hpp"
+#include "Simulator.hpp"
+#include "SharerDirectory.hpp"
+#include "Stats.hpp"
+#include "Topology.hpp"
+#include "TraceWriter.hpp"
 
 class PE; // Forward declaration
+class CheckpointReader;
+class CheckpointWriter;
 
-// Estructura para comparar mensajes por QoS
-struct CompareMessages {
-    bool operator()(const Message& a, const Message& b) {
-        return a.qos > b.qos;
-    }
+// Organización del bus
+enum class BusMode {
+    ATOMIC, // Cada transacción toma el bus de principio a fin (comportamiento original)
+    SPLIT   // Solicitud y respuesta son fases separadas; varias transacciones en vuelo
 };
 
-class Interconnect {
+bool parseBusMode(const std::string& text, BusMode& mode); // "atomic" | "split"
+
+// Esquema de coherencia usado para las invalidaciones
+enum class CoherenceMode {
+    BROADCAST, // Se invalida a todos los PEs (comportamiento original)
+    DIRECTORY  // Se invalida solo a los PEs que comparten la línea
+};
+
+class Interconnect : public SimObject {
 public:
-    Interconnect();
-    ~Interconnect();
+    explicit Interconnect(Simulator* simulator, int arbiterMode = 0); // 0 FIFO, 1 Prioridad, 2 WRR, 3 DRR, 4 envejecimiento
 
-    void start();
-    void stop();
     void sendMessage(const Message& msg); // llamado por PEs
-    void registerPE(uint8_t id, PE* pe);
-    void join(); // Para esperar a que el hilo worker termine
-    int clockCycle = 0; // reloj interno del interconnect
+    void sendMessage(Message&& msg);
+    void registerPE(uint16_t id, PE* pe);
+    void handleEvent(EventType type, uint64_t now) override; // Eventos del kernel de simulación
+    void setCoherenceMode(CoherenceMode mode);
+    void setCoherenceProtocol(CoherenceProtocol protocol); // También configura los PEs ya registrados
+    CoherenceProtocol getCoherenceProtocol() const;
+    size_t writeBackCaches(); // Con protocolo: vuelca a memoria las líneas sucias de los PEs (fin de la simulación)
+    void setLineSize(uint32_t size); // Tamaño de línea de las cachés de los PEs (granularidad del directorio)
+    void setBusMode(BusMode mode, size_t maxInFlight); // maxInFlight solo aplica al modo SPLIT
+    void setTopology(const TopologyConfig& config); // Después de registrar los PEs (un nodo por PE + la memoria)
+    const Topology* getTopology() const;            // nullptr con el bus compartido
+    uint64_t getInvalidationsSent() const;    // Mensajes de invalidación enviados a PEs
+    uint64_t getInvalidationsAvoided() const; // Invalidaciones que el directorio evitó respecto a broadcast
+    MainMemory& getMainMemory(); // Para configurarla, precargarla y guardar instantáneas
+    uint64_t getBusBusyCycles() const;          // Ciclos en que el bus transfirió datos
+    uint64_t getCompletedTransactions() const;  // READ_MEM / WRITE_MEM respondidos
+    size_t getPeakInFlight() const;             // Máximo de transacciones en vuelo (modo SPLIT)
+    const LatencyHistogram& getLatency(uint16_t pe) const; // Emisión de la solicitud → llegada de la respuesta
+    const InterconnectStats& getStats() const;
+
+    // Avance rápido de la simulación muestreada: aplica el efecto de una solicitud de un PE sobre la
+    // memoria, las cachés y el directorio, sin tiempo, trazas, contadores de tráfico ni respuestas.
+    // Un READ_MEM sin protocolo deja en msg.data los bytes leídos; con protocolo la línea queda
+    // instalada en la caché del solicitante.
+    void functionalAccess(Message& msg);
+
+    // Línea que un PE instaló en su caché sin pasar por el interconnect (escritura sin protocolo). Con
+    // directorio queda registrado como compartidor desde ese momento, no recién cuando se concede el
+    // WRITE_MEM: una invalidación intermedia no debe saltearlo.
+    void recordSharer(uint16_t pe, uint32_t addr);
+
+    // Checkpoint: reloj, árbitro, transacciones en vuelo, red, directorio, memoria principal y
+    // estadísticas. loadState espera un interconnect recién configurado igual (PEs y topología incluidos);
+    // el ancho de banda y las latencias pueden cambiar.
+    void saveState(CheckpointWriter& out) const;
+    void loadState(CheckpointReader& in);
+    uint64_t clockCycle = 0; // reloj interno del interconnect (ciclo en que el bus, o el controlador en una red, queda libre)
     int BytesForCicle = 8; // Cuanta información se transfiere por ciclo
 
 private:
-    void processLoop(); // hilo del interconnect
-    void writeOutput(const std::string &line);
+    // Respuesta de una transacción que espera su fase en el bus
+    struct PendingResponse {
+        uint64_t ready = 0;  // Ciclo en que la memoria la deja lista
+        uint64_t seq = 0;    // Desempate determinista entre respuestas del mismo ciclo
+        uint64_t issued = 0; // Ciclo en que el PE emitió la solicitud
+        uint32_t bytes = 0;  // Bytes que ocupa en el bus
+        bool installs = false; // Con protocolo: la línea del solicitante queda legible al llegar la respuesta
+        Message response;
+    };
+
+    // Min-heap por (ready, seq)
+    struct ComparePending {
+        bool operator()(const PendingResponse& a, const PendingResponse& b) const {
+            if (a.ready != b.ready) return a.ready > b.ready;
+            return a.seq > b.seq;
+        }
+    };
+
+    // Solicitud que viaja por la red hacia el controlador de memoria (topologías distintas de bus)
+    struct NetworkArrival {
+        uint64_t arrival = 0; // Ciclo en que llega el último byte al controlador
+        uint64_t seq = 0;
+        Message msg;
+    };
 
-    int getclockCycle() const;
+    // Min-heap por (arrival, seq)
+    struct CompareArrival {
+        bool operator()(const NetworkArrival& a, const NetworkArrival& b) const {
+            if (a.arrival != b.arrival) return a.arrival > b.arrival;
+            return a.seq > b.seq;
+        }
+    };
 
-    std::string outputPath;
+    static constexpr uint64_t NO_SERVICE = UINT64_MAX;
+
+    void service(uint64_t now); // concede el bus según el modo
+    void serviceAtomic(uint64_t now);
+    void serviceSplit(uint64_t now);
+    void serviceNetwork(uint64_t now); // controlador de memoria detrás de una red de enlaces
+    size_t transactionLimit() const;
+    void scheduleNextService();
+    void requestService(uint64_t time);
+    PendingResponse beginTransaction(const Message& msg);              // fase de solicitud
+    uint64_t finishTransaction(PendingResponse& pending, uint64_t start); // fase de respuesta
+    void coherentRead(const Message& msg, PendingResponse& pending);  // READ_MEM con protocolo (GetS)
+    void coherentWrite(const Message& msg, PendingResponse& pending); // WRITE_MEM con protocolo (GetM)
+    void findHolders(uint32_t addr, uint16_t requester); // PEs con copia válida → invalidationTargets
+    uint64_t lineTransfer(uint16_t from, uint64_t start);  // Una línea viaja de la caché de from al controlador
+    void installLine(uint16_t pe, uint32_t addr, CoherenceState state, const uint8_t* line);
+    void writeBack(uint32_t lineAddr, const uint8_t* line); // Línea sucia a memoria (no ocupa el bus)
+    void functionalRead(const Message& msg);  // functionalAccess de READ_MEM con protocolo
+    void functionalWrite(const Message& msg); // functionalAccess de WRITE_MEM con protocolo
+    void functionalInstall(uint16_t pe, uint32_t addr, CoherenceState state, const uint8_t* line);
+    void recallDirtyLine(uint16_t pe, uint32_t addr);       // Write-back sin protocolo: antes de invalidar
+    void invalidate(const Message& msg);
+    void invalidateNetwork(const Message& msg, uint64_t now);
+    void deliver(PE* pe, Message& response, uint64_t arrival); // agenda la entrega de una respuesta
+    void writeOutput(uint64_t cycle, MessageType type, uint8_t direction, size_t size, uint32_t addr,
+                     TracePeer peer, uint16_t peerId = 0);
+
+    uint64_t getclockCycle() const;
+
+    // Consola y puertas de avance de la simulación a la que pertenece
+    bool consoleTrace() const { return simulator->getRunControl().consoleTrace(); }
+    std::mutex& consoleMutex() const { return simulator->getRunControl().consoleMutex(); }
+    void stepGate(int cycle, int pe, const char* msgType) const {
+        simulator->getRunControl().stepGate(cycle, pe, msgType);
+    }
 
     MainMemory mainMemory;
+    Simulator* simulator;
 
-    std::vector<Message> fifoMessageQueue;
-    std::priority_queue<Message, std::vector<Message>, CompareMessages> priorityMessageQueue;
+    std::unique_ptr<Arbiter> arbiter; // Política de arbitraje (FIFO o Prioridad)
     std::mutex queueMutex;
-    std::condition_variable cv;
-    bool running = false;
-    std::thread worker;
-    std::unordered_map<uint8_t, PE*> peDirectory; // ID del PE → puntero al PE
+    uint64_t nextServiceAt = NO_SERVICE; // Ciclo del próximo servicio agendado en el kernel
+
+    BusMode busMode = BusMode::ATOMIC;
+    size_t maxInFlight = 1;
+    size_t inFlight = 0;
+    size_t peakInFlight = 0;
+    std::vector<PendingResponse> pendingResponses; // Heap ordenado por ComparePending
+    uint64_t nextPendingSeq = 0;
+    uint64_t busyCycles = 0;
+    uint64_t completedTransactions = 0;
+    std::unique_ptr<Topology> topology; // Red de enlaces; nullptr con el bus compartido
+    uint16_t memoryNode = 0;            // Nodo del controlador de memoria en la red
+    std::vector<NetworkArrival> networkArrivals; // Heap ordenado por CompareArrival
+    std::vector<LatencyHistogram> latencies; // Por PE, indexado por ID
+    std::vector<PE*> peDirectory; // ID del PE → puntero al PE (arreglo denso indexado por ID)
+    std::vector<uint64_t> scheduledDelivery; // Por PE: ciclo de la última entrega agendada
+
+    CoherenceMode coherenceMode = CoherenceMode::BROADCAST;
+    SharerDirectory sharerDirectory; // Compartidores por línea (modo DIRECTORY)
+    std::vector<uint16_t> invalidationTargets; // Destinos de la invalidación en curso
+    uint64_t invalidationsSent = 0;
+    uint64_t invalidationsAvoided = 0;
+
+    CoherenceProtocol protocol = CoherenceProtocol::NONE;
+    uint32_t lineSize = 16;
+
+    InterconnectStats stats;
 };
 
-#endif // INTERCONNECT_HPP
\ No newline at end of file
+#endif // INTERCONNECT_HPP
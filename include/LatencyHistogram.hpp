@@ -0,0 +1,49 @@
+#ifndef LATENCYHISTOGRAM_HPP
+#define LATENCYHISTOGRAM_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class CheckpointReader;
+class CheckpointWriter;
+
+// Histograma de latencias en ciclos con buckets log-lineales: exactos por debajo de 64 ciclos y
+// 32 sub-buckets por potencia de dos por encima (error relativo < 3.2%). Memoria acotada sin
+// importar cuántas muestras se registren.
+class LatencyHistogram {
+public:
+    void record(uint64_t cycles);
+    void merge(const LatencyHistogram& other);
+
+    uint64_t percentile(double p) const; // p en [0, 100]; cota superior del bucket (o el máximo)
+    uint64_t count() const;
+    uint64_t max() const;
+    double mean() const;
+    uint64_t sum() const; // Suma de todas las muestras
+
+    void saveState(CheckpointWriter& out) const; // Checkpoint: buckets y totales
+    void loadState(CheckpointReader& in);
+
+    // Recorre los buckets no vacíos en orden: visit(desde, hasta, muestras), con límites inclusivos
+    template <typename Visit>
+    void forEachBucket(Visit&& visit) const {
+        for (size_t i = 0; i < buckets.size(); ++i) {
+            if (buckets[i]) visit(i ? bucketUpper(i - 1) + 1 : 0, bucketUpper(i), buckets[i]);
+        }
+    }
+
+private:
+    static constexpr unsigned EXACT_BITS = 6; // Valores < 64 en buckets exactos
+    static constexpr unsigned SUB_BITS = 5;   // 32 sub-buckets por potencia de dos
+
+    static size_t bucketOf(uint64_t cycles);
+    static uint64_t bucketUpper(size_t bucket);
+
+    std::vector<uint64_t> buckets;
+    uint64_t samples = 0;
+    uint64_t total = 0;
+    uint64_t maxCycles = 0;
+};
+
+#endif // LATENCYHISTOGRAM_HPP
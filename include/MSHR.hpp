@@ -0,0 +1,64 @@
+#ifndef MSHR_HPP
+#define MSHR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class CheckpointReader;
+class CheckpointWriter;
+
+// Registros de fallos pendientes (MSHR) de un PE. Cada entrada sigue una línea con un
+// READ_MEM en vuelo; un fallo a una línea ya pendiente se combina con la entrada existente
+// en lugar de enviar otro mensaje. Con todas las entradas ocupadas el PE se detiene.
+// Capacidad 0 desactiva el modelo (fallos ilimitados y sin combinar, comportamiento original).
+class MSHRFile {
+public:
+    enum class Result {
+        PRIMARY,   // Entrada nueva: hay que enviar el READ_MEM
+        SECONDARY, // Línea ya pendiente: se combina, sin mensaje nuevo
+        FULL       // Sin entradas libres: el PE debe detenerse
+    };
+
+    void setCapacity(size_t entries);
+    bool enabled() const;
+
+    Result allocate(uint32_t line, uint64_t now);
+    bool release(uint32_t line, uint64_t now); // true si la línea tenía una entrada
+
+    size_t outstanding() const;
+
+    void saveState(CheckpointWriter& out) const; // Checkpoint: entradas y estadísticas (misma capacidad)
+    void loadState(CheckpointReader& in);
+
+    // Estadísticas
+    uint64_t getPrimaryMisses() const;
+    uint64_t getSecondaryMisses() const;
+    uint64_t getFullEvents() const;          // Fallos que encontraron las entradas llenas
+    size_t getPeakOutstanding() const;
+    double getMemoryLevelParallelism() const; // Fallos en vuelo promedio mientras hubo al menos uno
+    uint64_t getOutstandingCycles() const;    // Suma de fallos en vuelo por ciclo
+    uint64_t getMissCycles() const;           // Ciclos con al menos un fallo en vuelo
+
+private:
+    struct Entry {
+        uint32_t line = 0;
+        uint32_t targets = 0; // Lecturas esperando esta línea (la primaria + las combinadas)
+        bool valid = false;
+    };
+
+    void advance(uint64_t now); // Integra fallos en vuelo x ciclos hasta now
+
+    std::vector<Entry> entries;
+    size_t active = 0;
+
+    uint64_t primaryMisses = 0;
+    uint64_t secondaryMisses = 0;
+    uint64_t fullEvents = 0;
+    size_t peakOutstanding = 0;
+    uint64_t lastChange = 0;
+    uint64_t outstandingCycles = 0; // Suma de fallos en vuelo por ciclo
+    uint64_t busyCycles = 0;        // Ciclos con al menos un fallo en vuelo
+};
+
+#endif // MSHR_HPP
@@ -1,21 +1,124 @@
 #ifndef MAINMEMORY_HPP
 #define MAINMEMORY_HPP
 
-#include <vector>
+#include <array>
+#include <atomic>
+#include <bitset>
+#include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <mutex>
+#include <string>
 
+class CheckpointReader;
+class CheckpointWriter;
+
+// Configuración de la memoria principal. Por defecto: 16KB en páginas dispersas.
+struct MemoryConfig {
+    uint64_t sizeBytes = 4096 * 4; // Hasta 4GB (direcciones de 32 bits)
+    std::string backingFile;       // Si no está vacío, la memoria es este archivo mapeado con mmap
+    std::string imageFile;         // Imagen binaria que se precarga desde la dirección 0
+    size_t banks = 1;              // Bancos entrelazados por dirección (potencia de 2)
+    size_t interleaveBytes = 64;   // Bytes consecutivos de un mismo banco (potencia de 2)
+    uint64_t bankLatency = 0;      // Ciclos desde que el banco acepta el acceso hasta que termina
+    uint64_t bankOccupancy = 0;    // Ciclos que el banco queda ocupado por acceso (< latencia → segmentado)
+};
+
+// Devuelve un mensaje de error si la configuración no es válida, o un string vacío si lo es
+std::string memoryConfigError(const MemoryConfig& config);
+
+// Convierte "65536", "64K", "16M" o "4G" a bytes
+bool parseByteSize(const std::string& text, uint64_t& bytes);
+
+// Memoria principal dispersa por páginas de 4KB. Sin archivo de respaldo, una tabla de dos
+// niveles reserva cada página en su primera escritura: las páginas nunca escritas no ocupan
+// memoria y se leen como ceros, y el costo de arranque no depende del tamaño configurado.
+// Con archivo de respaldo, el archivo se mapea con mmap y el sistema operativo carga las
+// páginas bajo demanda; lo escrito queda en el archivo al terminar.
+//
+// La memoria se divide en bancos entrelazados cada interleaveBytes. Cada banco tiene su propio
+// lock y su propio modelo de ocupación, así que accesos a bancos distintos avanzan en paralelo
+// tanto en el host como en el tiempo simulado. La tabla de páginas se actualiza sin locks.
 class MainMemory {
 public:
-    MainMemory();
+    static constexpr uint64_t PAGE_SIZE = 4096;
+    static constexpr uint64_t MAX_SIZE = uint64_t(1) << 32;
+    static constexpr size_t MAX_BANKS = 1024;
+
+    explicit MainMemory(uint64_t sizeBytes = MemoryConfig{}.sizeBytes);
+    ~MainMemory();
+
+    MainMemory(const MainMemory&) = delete;
+    MainMemory& operator=(const MainMemory&) = delete;
+
+    // Reinicia la memoria con la configuración dada (mapea el archivo y precarga la imagen).
+    // Informa el error por std::cerr y devuelve false si algo falla.
+    bool configure(const MemoryConfig& config);
+
+    // Copian directamente entre la memoria y el buffer del llamador (sin memoria dinámica
+    // salvo la primera escritura de una página). Devuelven false si el acceso queda fuera de rango.
+    bool read(uint32_t addr, uint8_t* out, size_t size);
+    bool write(uint32_t addr, const uint8_t* data, size_t size);
+
+    // Modelo de tiempo: reserva los bancos que toca el acceso a partir del ciclo now y devuelve
+    // el ciclo en que termina. Un banco ocupado por otro acceso retrasa el inicio (conflicto); un
+    // acceso que da la vuelta a todos los bancos ocupa cada uno una sola vez.
+    uint64_t access(uint32_t addr, size_t size, uint64_t now);
 
-    std::vector<uint8_t> read(uint32_t addr, size_t size);
-    void write(uint32_t addr, const std::vector<uint8_t>& data);
+    bool loadImage(const std::string& path);    // Copia el archivo desde la dirección 0
+    bool saveSnapshot(const std::string& path); // Imagen completa (archivo disperso: solo las páginas con datos)
+
+    // Checkpoint: estado de los bancos y páginas que no son solo ceros. loadState reemplaza todo el
+    // contenido (con archivo de respaldo, lo que no está en el checkpoint queda en ceros).
+    void saveState(CheckpointWriter& out) const;
+    void loadState(CheckpointReader& in);
+
+    uint64_t size() const;
+    size_t residentPages() const; // Páginas reservadas (sin archivo de respaldo)
+    size_t getBanks() const;
+    uint64_t getBankAccesses() const;      // Accesos sumados de todos los bancos
+    uint64_t getBankConflictCycles() const; // Ciclos de espera por bancos ocupados
 
 private:
-    static constexpr size_t MEMORY_SIZE = 4096 * 4; // 4096 posiciones de 32 bits = 16KB
-    std::vector<uint8_t> memory;
-    std::mutex memMutex; // Para proteger acceso concurrente
+    static constexpr uint32_t PAGE_BITS = 12;
+    static constexpr uint32_t LEAF_BITS = 10;
+    static constexpr size_t LEAF_ENTRIES = size_t(1) << LEAF_BITS;
+    static constexpr size_t ROOT_ENTRIES = size_t(1) << (32 - PAGE_BITS - LEAF_BITS);
+
+    using Page = std::array<uint8_t, PAGE_SIZE>;
+    using Leaf = std::array<std::atomic<Page*>, LEAF_ENTRIES>;
+
+    // Estado de un banco; alineado para que bancos vecinos no compartan línea de caché del host
+    struct alignas(64) Bank {
+        std::mutex mutex;          // Protege los datos del banco y su estado de ocupación
+        uint64_t busyUntil = 0;    // Primer ciclo en que el banco acepta otro acceso
+        uint64_t accesses = 0;
+        uint64_t conflictCycles = 0;
+    };
+
+    bool mapBackingFile(const MemoryConfig& config); // Reinicia la tabla de páginas y mapea el archivo (si hay)
+    const Page* findPage(uint64_t pageNumber) const; // nullptr si nunca se escribió
+    Page& touchPage(uint64_t pageNumber);            // Reserva la página si no existe (sin locks)
+    void releasePages();
+    bool inRange(uint32_t addr, size_t size) const;
+    void unmap();
+
+    // Recorre [addr, addr + size) en tramos que no cruzan bancos ni páginas, con el lock del banco tomado
+    template <typename Fn>
+    void forEachChunk(uint64_t addr, size_t size, Fn&& fn);
+
+    uint64_t memorySize;
+    std::array<std::atomic<Leaf*>, ROOT_ENTRIES> root{}; // 1024 hojas x 1024 páginas x 4KB = 4GB
+    std::atomic<size_t> pages{0};
+
+    std::unique_ptr<Bank[]> banks;
+    size_t numBanks = 1;
+    uint32_t interleaveShift = 6; // log2(interleaveBytes)
+    uint64_t bankLatency = 0;
+    uint64_t bankOccupancy = 0;
+
+    uint8_t* mapped = nullptr; // Región mapeada del archivo de respaldo
+    mutable std::mutex configMutex; // Solo para configure/loadImage/saveSnapshot (no está en el camino de los accesos)
 };
 
 #endif // MAINMEMORY_HPP
@@ -1,8 +1,10 @@
 #ifndef MESSAGE_HPP
 #define MESSAGE_HPP
 
+#include <algorithm>
+#include <array>
+#include <cstddef>
 #include <cstdint>
-#include <vector>
 #include <string>
 
 enum class MessageType {
@@ -15,15 +17,72 @@ enum class MessageType {
     WRITE_RESP
 };
 
+constexpr size_t MESSAGE_TYPE_COUNT = size_t(MessageType::WRITE_RESP) + 1;
+
+// Carga útil de tamaño fijo embebida en el mensaje: copiar o mover un Message nunca usa memoria dinámica.
+// La capacidad alcanza para una línea de caché del tamaño máximo configurable.
+struct Payload {
+    static constexpr size_t CAPACITY = 64;
+
+    std::array<uint8_t, CAPACITY> bytes = {};
+    uint32_t length = 0;
+
+    size_t size() const { return length; }
+    bool empty() const { return length == 0; }
+    void clear() { length = 0; }
+    void resize(size_t n) { length = uint32_t(std::min(n, CAPACITY)); } // Se trunca a CAPACITY
+
+    uint8_t* data() { return bytes.data(); }
+    const uint8_t* data() const { return bytes.data(); }
+    uint8_t* begin() { return bytes.data(); }
+    uint8_t* end() { return bytes.data() + length; }
+    const uint8_t* begin() const { return bytes.data(); }
+    const uint8_t* end() const { return bytes.data() + length; }
+    uint8_t& operator[](size_t i) { return bytes[i]; }
+    uint8_t operator[](size_t i) const { return bytes[i]; }
+
+    // Rellena n bytes con value (truncado a CAPACITY)
+    void assign(size_t n, uint8_t value) {
+        resize(n);
+        std::fill(begin(), end(), value);
+    }
+
+    // Copia n bytes desde src (truncado a CAPACITY)
+    void assign(const uint8_t* src, size_t n) {
+        resize(n);
+        std::copy(src, src + length, begin());
+    }
+};
+
 struct Message {
-    MessageType type;
-    uint8_t src;                 // ID del PE origen
-    uint8_t dest;                // ID del PE destino
+    MessageType type = MessageType::READ_MEM;
+    uint16_t src = 0;            // ID del PE origen
+    uint16_t dest = 0;           // ID del PE destino
     uint32_t addr = 0;
     uint32_t size = 0;
-    std::vector<uint8_t> data;   // Para WRITE o READ_RESP
+    Payload data;                // Para WRITE o READ_RESP
     uint8_t qos = 0x00;          // Prioridad (0x00 - 0xFF)
-    bool status;                 //
+    bool status = false;         //
+    uint64_t cycle = 0;          // Ciclo de emisión (o de llegada, para respuestas)
 };
 
+// Bytes que ocupa un mensaje en el bus: encabezado de 6 bytes más la carga útil
+inline uint32_t messageBytes(const Message& msg) {
+    return uint32_t(6 + msg.data.size());
+}
+
+// Nombre textual del tipo de mensaje (igual al usado en los archivos de salida)
+inline const char* messageTypeName(MessageType type) {
+    switch (type) {
+        case MessageType::READ_MEM:             return "READ_MEM";
+        case MessageType::WRITE_MEM:            return "WRITE_MEM";
+        case MessageType::BROADCAST_INVALIDATE: return "BROADCAST_INVALIDATE";
+        case MessageType::INV_ACK:              return "INV_ACK";
+        case MessageType::INV_COMPLETE:         return "INV_COMPLETE";
+        case MessageType::READ_RESP:            return "READ_RESP";
+        case MessageType::WRITE_RESP:           return "WRITE_RESP";
+    }
+    return "UNKNOWN";
+}
+
 #endif // MESSAGE_HPP
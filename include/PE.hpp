@@ -1,67 +1,147 @@
 #ifndef PE_HPP
 #define PE_HPP
 
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
-#include <thread>
-#include "CacheBlock.hpp"
+#include "Cache.hpp"
+#include "InstructionStream.hpp"
+#include "MainMemory.hpp"
+#include "MSHR.hpp"
 #include "Message.hpp"
 #include "Interconnect.hpp"
-#include <queue>
-#include <mutex>
-#include <condition_variable>
+#include "Simulator.hpp"
+#include "SpscQueue.hpp"
+#include "Stats.hpp"
+#include "TraceWriter.hpp"
+#include "WriteCombiningBuffer.hpp"
 
 class Interconnect;
+class CheckpointReader;
+class CheckpointWriter;
 
-class PE {
+class PE : public SimObject {
 public:
-    PE(int id, uint8_t qos, Interconnect* interconnect);
+    PE(int id, uint8_t qos, Interconnect* interconnect, Simulator* simulator, const CacheConfig& cacheConfig = {});
 
-    void loadInstructions(const std::string& filepath);
+    bool loadInstructions(const std::string& filepath); // Decodifica el workload (false si no se pudo leer)
+    void setProgram(std::shared_ptr<const InstructionStream> program); // Programa ya decodificado (compartible)
     void getInstructions();
-    void start();
-    void join();
+    void start(); // Agenda la emisión de la primera instrucción en el kernel
+    void setMSHRs(size_t count); // Registros de fallos pendientes (0 → sin límite ni combinación)
+    void setCoherenceProtocol(CoherenceProtocol protocol); // NONE: write-through e invalidaciones del workload
+    void setWriteCombining(size_t entries); // Buffer de write-combining (0 → cada escritura sale por separado)
+
+    // Simulación muestreada. fastForward ejecuta la siguiente instrucción solo por su efecto sobre las
+    // cachés y la memoria, sin mensajes, trazas ni tiempo (false si el programa ya terminó); runDetailed
+    // emite hasta count instrucciones más con el modelo de tiempo completo desde el ciclo siguiente.
+    bool fastForward();
+    bool runDetailed(size_t count);
 
     void receiveResponse(const Message& msg);
+    void receiveResponse(Message&& msg);
     void handleResponses();
 
+    void handleEvent(EventType type, uint64_t now) override; // Eventos del kernel de simulación
+    void commitEvent(EventType type, uint64_t now) override;
+
     void invalidateCacheLine(uint32_t cache_line);
+    void writeToCache(uint32_t addr, const Payload& data);
+    Payload readFromCache(uint32_t addr, size_t size); // Carga vacía en caso de miss
+
+    // Operaciones del protocolo de coherencia: las usa el interconnect durante su servicio, que nunca
+    // corre en paralelo con los eventos de los PEs
+    CacheBlock* snoopLine(uint32_t addr); // Bloque de la línea sin alterar el reemplazo (nullptr si no está)
+    CacheBlock& installLine(uint32_t addr, CoherenceState state, CacheBlock& evicted); // Pendiente hasta setLineReady
+    void setLineReady(uint32_t addr, uint64_t cycle); // Ciclo en que llega la respuesta que instaló la línea
+    size_t writeBackDirtyLines(MainMemory& memory);   // Vuelca las líneas sucias (fin de la simulación)
+
+    // Checkpoint: posición en el programa, reloj, caché, MSHRs, buffer de write-combining, respuestas
+    // pendientes y estadísticas. loadState espera un PE recién creado con el mismo programa y configuración.
+    void saveState(CheckpointWriter& out) const;
+    void loadState(CheckpointReader& in);
 
-    void writeOutput(const std::string &line);
+    // Registra una línea "<op> <dir> <tamaño> <fuente/destino> <ciclo>" en el archivo del PE
+    void writeOutput(uint8_t op, uint8_t direction, size_t size, uint32_t addr,
+                     TracePeer peer = TracePeer::IC, uint16_t peerId = 0);
 
     int getId() const;
     uint8_t getQoS() const;
 
-    int getCycleCounter() const;
-    void setCycleCounter(int newClock);
+    uint64_t getCycleCounter() const;
+    size_t getInstructionPointer() const;     // Instrucciones ya emitidas (o ejecutadas en avance rápido)
 
     bool getComplete() const;
+    const MSHRFile& getMSHRs() const;
+    uint64_t getStallCycles() const; // Ciclos detenido por MSHRs llenos
+    const PEStats& getStats() const;
+    const WriteCombiningBuffer& getWriteCombining() const;
 
 private:
-    void execute();  // función para el hilo
-    void executeInstruction(const std::string& instruction);
+    void executeInstruction(size_t index);
+    void copyIntoLine(CacheBlock& block, uint32_t addr, const Payload& data);
+    void writeDirty(uint32_t addr, const Payload& data); // Write-back: escribe la línea y marca los bytes sucios
+    CacheBlock& allocateLine(uint32_t addr);      // Como cache.allocate, escribiendo la víctima si está sucia
+    void writeBackLine(CacheBlock& block);         // Envía los bytes sucios de la línea y la deja limpia
+    void flushCombined();                          // Envía las entradas que dejó el buffer de write-combining
+    void sendWrite(uint32_t addr, const uint8_t* data, size_t size); // WRITE_MEM generado por la caché
+    void sendOutbox();
+    void reportAllocatedLines();                   // Informa al directorio las líneas de allocatedLines
+
+    // Consola y puertas de avance de la simulación a la que pertenece
+    bool consoleTrace() const { return simulator->getRunControl().consoleTrace(); }
+    std::mutex& consoleMutex() const { return simulator->getRunControl().consoleMutex(); }
+    void stepGate(int cycle, int pe, const char* msgType) const {
+        simulator->getRunControl().stepGate(cycle, pe, msgType);
+    }
     int id;
     uint8_t qos;
     Interconnect* interconnect;
-    std::vector<std::string> instructionMemory;
-
-    std::thread thread;
-
-    std::string outputPath;
+    Simulator* simulator;
+    std::shared_ptr<const InstructionStream> instructionMemory; // Programa decodificado
+    size_t instructionPointer = 0; // Siguiente instrucción a emitir
+    size_t issueLimit = SIZE_MAX;  // Fin de la ventana detallada (simulación muestreada)
+    bool fastForwarding = false;   // Las escrituras a memoria se aplican en el acto (sin mensajes)
 
     //Cache
-    static constexpr int NUM_BLOCKS = 128;
-    std::array<CacheBlock, NUM_BLOCKS> cache;
-
-    std::queue<Message> responseQueue;
-    std::mutex responseMutex;
-    std::condition_variable responseCV;
+    Cache cache; // Asociativa por conjuntos, geometría y reemplazo configurables
+    CoherenceProtocol protocol = CoherenceProtocol::NONE;
+
+    std::vector<Message> outbox; // Mensajes emitidos en el ciclo actual, pendientes de enviar
+    std::vector<uint32_t> allocatedLines; // Líneas que la caché tomó por su cuenta en el ciclo (sin protocolo)
+
+    WriteCombiningBuffer writeCombining;
+    std::vector<WriteCombiningEntry> combinedLines; // Entradas que salen del buffer (reutilizado)
+
+    SpscQueue<Message> inbox; // Respuestas recibidas: solo el interconnect agrega y solo el PE extrae, sin locks
+
+    // Respuestas ya sacadas de la bandeja que todavía no llegaron. En una red una respuesta enviada
+    // después puede llegar antes (toma un hueco anterior de los enlaces), así que se ordenan por ciclo
+    // de llegada en un min-heap; order desempata en el orden de entrega.
+    struct ArrivingResponse {
+        uint64_t order = 0;
+        Message msg;
+    };
+    struct LaterArrival {
+        bool operator()(const ArrivingResponse& a, const ArrivingResponse& b) const {
+            if (a.msg.cycle != b.msg.cycle) return a.msg.cycle > b.msg.cycle;
+            return a.order > b.order;
+        }
+    };
+    std::vector<ArrivingResponse> arriving;
+    uint64_t arrivalOrder = 0;
+
+    uint64_t cycleCounter = 0; // Contador local de ciclos
+    bool complete = false;
 
-    void writeToCache(uint32_t addr, const std::vector<uint8_t>& data);
-    std::vector<uint8_t> readFromCache(uint32_t addr, size_t size);
+    MSHRFile mshrs;
+    bool stalled = false;      // La instrucción actual espera un MSHR libre
+    bool resumeIssue = false;  // Se liberó un MSHR: reanudar la emisión en la fase de commit
+    uint64_t stallStart = 0;
+    uint64_t stallCycles = 0;
 
-    int cycleCounter = 0; // Contador local de ciclos
-    bool complete = false;
+    PEStats stats;
 
 };
 
@@ -0,0 +1,66 @@
+#ifndef RINGQUEUE_HPP
+#define RINGQUEUE_HPP
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+// Cola FIFO sobre un buffer circular de capacidad potencia de 2.
+// push y pop son O(1): los elementos nunca se desplazan al extraer el frente.
+// Cuando el buffer se llena la capacidad se duplica (costo amortizado O(1)).
+template <typename T>
+class RingQueue {
+public:
+    explicit RingQueue(size_t initialCapacity = 64) {
+        size_t capacity = 1;
+        while (capacity < initialCapacity) capacity <<= 1;
+        buffer = std::make_unique<T[]>(capacity);
+        mask = capacity - 1;
+    }
+
+    void push(const T& value) {
+        if (count > mask) grow();
+        buffer[(head + count) & mask] = value;
+        count++;
+    }
+
+    void push(T&& value) {
+        if (count > mask) grow();
+        buffer[(head + count) & mask] = std::move(value);
+        count++;
+    }
+
+    T& front() { return buffer[head]; }
+    const T& front() const { return buffer[head]; }
+    const T& at(size_t i) const { return buffer[(head + i) & mask]; } // i-ésimo desde el frente
+
+    // Extrae el frente moviéndolo fuera del buffer
+    T pop() {
+        T value = std::move(buffer[head]);
+        head = (head + 1) & mask;
+        count--;
+        return value;
+    }
+
+    bool empty() const { return count == 0; }
+    size_t size() const { return count; }
+    size_t capacity() const { return mask + 1; }
+
+private:
+    // Duplica la capacidad copiando los elementos en orden al inicio del nuevo buffer
+    void grow() {
+        size_t capacity = (mask + 1) << 1;
+        auto bigger = std::make_unique<T[]>(capacity);
+        for (size_t i = 0; i < count; ++i) bigger[i] = std::move(buffer[(head + i) & mask]);
+        buffer = std::move(bigger);
+        head = 0;
+        mask = capacity - 1;
+    }
+
+    std::unique_ptr<T[]> buffer;
+    size_t mask = 0;   // capacidad - 1
+    size_t head = 0;   // Posición del frente
+    size_t count = 0;  // Elementos en la cola
+};
+
+#endif // RINGQUEUE_HPP
@@ -0,0 +1,52 @@
+#ifndef RUNCONTROL_HPP
+#define RUNCONTROL_HPP
+
+#include <atomic>
+#include <mutex>
+#include <string>
+
+// Modos de avance de la simulación
+enum class RunMode {
+    INTERACTIVE, // Pausa en cada paso (Enter para avanzar)
+    BATCH,       // Sin pausas, ejecución a velocidad nativa
+    STEP         // Pausa solo en los puntos de quiebre configurados
+};
+
+// Condiciones de quiebre para el modo STEP (-1 / "" significa "cualquiera")
+struct Breakpoints {
+    int cycle = -1;       // Ciclo exacto en el que se pausa
+    int pe = -1;          // PE que debe estar involucrado
+    std::string msgType;  // Tipo de mensaje/instrucción (ej: "READ_MEM")
+};
+
+// Modo de avance y consola de una simulación. Cada Simulator tiene el suyo, así varias simulaciones
+// pueden correr en el mismo proceso sin compartir estado. Por defecto: batch y sin eventos en consola.
+class RunControl {
+public:
+    void configure(RunMode mode, const Breakpoints& breakpoints, bool verbose);
+
+    // Puerta de avance: según el modo, espera a que el usuario presione Enter o retorna inmediatamente.
+    // Recibe el nombre como const char* (opcodeName/messageTypeName) para no armar strings por paso.
+    void stepGate(int cycle, int pe, const char* msgType);
+
+    // Indica si se deben imprimir los eventos en consola
+    bool consoleTrace() const { return verboseOutput; }
+
+    // Serializa las líneas que los hilos de esta simulación imprimen en consola
+    std::mutex& consoleMutex() { return outputMutex; }
+
+private:
+    bool matchesBreakpoint(int cycle, int pe, const char* msgType) const;
+
+    RunMode runMode = RunMode::BATCH;
+    Breakpoints breakpoints;
+    bool verboseOutput = false;
+    std::atomic<bool> breakpointsEnabled{true}; // Se desactiva si el usuario escribe "c" en una pausa
+    std::mutex outputMutex;
+    std::mutex inputMutex;
+};
+
+// Convierte un texto ("batch", "step", ...) al modo correspondiente
+bool parseRunMode(const std::string& text, RunMode& mode);
+
+#endif // RUNCONTROL_HPP
@@ -0,0 +1,58 @@
+#ifndef SAMPLING_HPP
+#define SAMPLING_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Simulación muestreada (estilo SMARTS): cada período de instrucciones por PE empieza con un avance
+// rápido funcional (solo cachés, memoria y directorio, sin tiempo ni mensajes) y termina con una
+// ventana detallada con el modelo de tiempo completo del interconnect
+struct SamplingConfig {
+    uint64_t period = 0;    // Instrucciones por PE de cada período (0 → sin muestreo)
+    uint64_t window = 1000; // Instrucciones por PE de cada ventana detallada
+    uint64_t warmup = 500;  // Ciclos al comienzo de cada ventana que no se miden (las colas arrancan vacías)
+
+    bool enabled() const { return period > 0; }
+};
+
+// Devuelve un mensaje de error si la configuración no es válida, o un string vacío si lo es
+std::string samplingConfigError(const SamplingConfig& config);
+
+// Media de una serie de muestras con su intervalo de confianza del 95% (t de Student, n - 1 grados
+// de libertad). Acumula con el método de Welford para no perder precisión con muchas muestras.
+class SampleSeries {
+public:
+    void add(double value);
+
+    size_t count() const;
+    double mean() const;
+    double halfWidth() const; // Semiancho del intervalo del 95% (0 con menos de dos muestras)
+
+private:
+    size_t samples = 0;
+    double average = 0.0;
+    double squares = 0.0; // Suma de los cuadrados de las desviaciones respecto de la media
+};
+
+// Resultado de una simulación muestreada: cada ventana detallada aporta una muestra de ciclos por
+// instrucción del sistema (ciclos hasta drenar el interconnect / instrucciones de todos los PEs) y
+// una de latencia media solicitud → respuesta. Los totales se extrapolan al programa completo.
+struct SamplingResult {
+    size_t windows = 0;
+    size_t saturatedWindows = 0; // El interconnect tardó en drenar más de lo que los PEs tardaron en emitir
+    uint64_t detailedInstructions = 0;
+    uint64_t fastForwardInstructions = 0;
+    uint64_t detailedCycles = 0;
+    SampleSeries cyclesPerInstruction;
+    SampleSeries latency;
+
+    // Si la mayoría de las ventanas satura el interconnect, en la ejecución completa la cola crece
+    // durante todo el programa y la latencia depende de su largo: las ventanas no la representan
+    bool latencyEstimable() const;
+    uint64_t totalInstructions() const;
+    double estimatedCycles() const;          // Ciclos por instrucción medios × instrucciones totales
+    double estimatedCyclesHalfWidth() const; // Semiancho del intervalo del 95% de estimatedCycles
+};
+
+#endif // SAMPLING_HPP
@@ -0,0 +1,39 @@
+#ifndef SHARERDIRECTORY_HPP
+#define SHARERDIRECTORY_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+class CheckpointReader;
+class CheckpointWriter;
+
+// Directorio de compartidores: para cada línea de caché guarda qué PEs pueden tenerla.
+// Cada línea usa un bitset (un bit por PE) que crece según el ID de PE más alto registrado.
+// Es conservador: un PE que reemplaza la línea en su caché sigue figurando hasta ser invalidado.
+class SharerDirectory {
+public:
+    void setLineSize(uint32_t size); // Debe coincidir con el tamaño de línea de las cachés (16 por defecto)
+
+    void addSharer(uint32_t addr, uint16_t pe);
+    void removeSharer(uint32_t addr, uint16_t pe);
+    bool isSharer(uint32_t addr, uint16_t pe) const;
+
+    // Llena `out` con los compartidores de la línea (en orden de ID), excluyendo a `exclude`
+    void sharers(uint32_t addr, std::vector<uint16_t>& out, int exclude = -1) const;
+
+    // Deja a `keeper` como único compartidor (o ninguno si keeper < 0)
+    void invalidateOthers(uint32_t addr, int keeper);
+
+    size_t trackedLines() const;
+
+    void saveState(CheckpointWriter& out) const; // Checkpoint: líneas en orden de número de línea
+    void loadState(CheckpointReader& in);
+
+private:
+    uint32_t lineSize = 16;
+    std::unordered_map<uint32_t, std::vector<uint64_t>> lines; // línea → bitset de PEs
+};
+
+#endif // SHARERDIRECTORY_HPP
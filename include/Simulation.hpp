@@ -0,0 +1,111 @@
+#ifndef SIMULATION_HPP
+#define SIMULATION_HPP
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "Cache.hpp"
+#include "Checkpoint.hpp"
+#include "Coherence.hpp"
+#include "Interconnect.hpp"
+#include "MainMemory.hpp"
+#include "PE.hpp"
+#include "RunControl.hpp"
+#include "Sampling.hpp"
+#include "Simulator.hpp"
+#include "Topology.hpp"
+#include "TraceWriter.hpp"
+#include "WorkloadGenerator.hpp"
+
+// Parámetros de una ejecución completa: lo que main arma a partir de la línea de comandos.
+// Todo el estado de la simulación cuelga de una instancia de Simulation, así que varias
+// configuraciones pueden correr a la vez en el mismo proceso (ver tools/sweep.cpp).
+struct SimulationConfig {
+    int arbiterMode = 0;                  // 0 FIFO, 1 Prioridad, 2 WRR, 3 DRR, 4 Prioridad con envejecimiento
+    bool synthetic = false;               // Workload generado (workload.pattern) o test de workloadsDir
+    int testNumber = 1;
+    WorkloadConfig workload;
+    std::string workloadsDir = "../workloads";
+    std::string outputDir = "../output";  // intconnect y peN (.txt o .bin)
+
+    RunMode runMode = RunMode::INTERACTIVE;
+    Breakpoints breakpoints;
+    bool verbose = false;                 // Eventos en consola también en modo batch
+    int numPEs = 8;
+    int workerThreads = 1;
+
+    CoherenceMode coherenceMode = CoherenceMode::BROADCAST;
+    CoherenceProtocol protocol = CoherenceProtocol::NONE;
+    CacheConfig cacheConfig;
+    TraceFormat traceFormat = TraceFormat::TEXT;
+    MemoryConfig memoryConfig;
+    BusMode busMode = BusMode::ATOMIC;
+    int maxInFlight = 8;
+    TopologyConfig topologyConfig;
+    int mshrCount = 0;
+    int writeCombiningEntries = 0;
+
+    std::string checkpointPath;     // Guarda el estado completo antes del ciclo checkpointCycle
+    uint64_t checkpointCycle = 0;
+    bool checkpointExit = false;    // Termina después de guardar el checkpoint
+    std::string restorePath;        // Arranca desde un checkpoint en lugar del ciclo 0
+
+    SamplingConfig sampling;        // Avance rápido funcional con ventanas detalladas periódicas
+};
+
+// Aplica una opción "--nombre=valor" de la línea de comandos. false con el motivo en error si la
+// opción es desconocida o su valor no es válido.
+bool parseSimulationOption(const std::string& arg, SimulationConfig& config, std::string& error);
+
+// Devuelve un mensaje de error si la combinación de opciones no es válida, o un string vacío si lo es
+std::string simulationConfigError(const SimulationConfig& config);
+
+// Parámetros que determinan la forma del estado ("clave=valor" separados por espacios). Un checkpoint
+// solo se restaura con los mismos; los de tiempo (--link-bw, --hop-latency, --inflight, --mem-latency,
+// --mem-occupancy) pueden cambiar para bifurcar experimentos desde un mismo estado.
+std::string checkpointKey(const SimulationConfig& config);
+
+// Una simulación: trazas, kernel, interconnect, memoria y PEs de una configuración
+class Simulation {
+public:
+    explicit Simulation(const SimulationConfig& config);
+
+    // Configura la memoria, crea los PEs y les asigna sus programas (generados o leídos de
+    // workloadsDir); con restorePath, además carga el checkpoint. false, con el error en std::cerr,
+    // si algo no se pudo preparar.
+    bool prepare();
+
+    // Procesa todos los eventos hasta que no queden instrucciones ni mensajes. Con checkpointPath se
+    // detiene antes de checkpointCycle, guarda el estado y sigue (o termina, con checkpointExit).
+    // Con muestreo alterna avance rápido y ventanas detalladas (ver getSampling).
+    // false si el checkpoint no se pudo guardar.
+    bool run();
+
+    // Estado completo (kernel, interconnect, memoria y PEs) en un archivo binario. El checkpoint se
+    // restaura sobre una simulación recién preparada con la misma checkpointKey.
+    bool saveCheckpoint(const std::string& path);
+    bool loadCheckpoint(const std::string& path);
+
+    std::string instructionPath() const; // Carpeta del test (sin workload sintético)
+
+    const SimulationConfig& getConfig() const;
+    const SamplingResult& getSampling() const; // Muestras y estimaciones de una simulación muestreada
+    Simulator& getSimulator();
+    Interconnect& getInterconnect();
+    TraceWriter& getTraceWriter();
+    const std::vector<std::unique_ptr<PE>>& getPEs() const;
+
+private:
+    std::vector<SimObject*> eventTargets(); // Tabla de destinos de eventos: interconnect y PEs por ID
+    void runSampled();
+
+    SimulationConfig config;
+    TraceWriter traceWriter;
+    Simulator simulator;
+    Interconnect interconnect;
+    std::vector<std::unique_ptr<PE>> pes;
+    bool restored = false;
+    SamplingResult sampling;
+};
+
+#endif // SIMULATION_HPP
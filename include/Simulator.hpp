@@ -0,0 +1,103 @@
+#ifndef SIMULATOR_HPP
+#define SIMULATOR_HPP
+
+#include <cstdint>
+#include <memory>
+#include <queue>
+#include <vector>
+#include "RunControl.hpp"
+#include "WorkerPool.hpp"
+
+class CheckpointReader;
+class CheckpointWriter;
+class TraceWriter;
+
+// Tipos de evento que maneja el kernel de simulación.
+// El orden de la enumeración define la prioridad entre eventos del mismo ciclo.
+enum class EventType {
+    RESPONSE_DELIVERY,    // Entrega de respuestas del Interconnect a un PE
+    PE_ISSUE,             // Emisión de la siguiente instrucción de un PE
+    INTERCONNECT_SERVICE  // El bus queda libre y arbitra el siguiente mensaje
+};
+
+// Interfaz de los componentes que reciben eventos del kernel (PEs e Interconnect).
+// Los eventos de PE (PE_ISSUE y RESPONSE_DELIVERY) de un mismo ciclo se procesan en dos fases:
+// handleEvent puede correr en paralelo en el grupo de hilos (solo toca estado propio) y
+// commitEvent corre después, en orden, en el hilo del kernel (envía mensajes y agenda eventos).
+class SimObject {
+public:
+    virtual ~SimObject() = default;
+    virtual void handleEvent(EventType type, uint64_t now) = 0;
+    virtual void commitEvent(EventType /*type*/, uint64_t /*now*/) {}
+
+    uint64_t batchMark = 0; // Último lote del kernel que incluyó a este componente
+};
+
+struct Event {
+    uint64_t time;      // Ciclo simulado en el que ocurre el evento
+    EventType type;     // Tipo de evento
+    uint64_t seq;       // Orden de inserción, desempata eventos idénticos de forma determinista
+    SimObject* target;  // Componente que procesa el evento
+};
+
+// Ordena los eventos por (ciclo, tipo, orden de inserción)
+struct CompareEvents {
+    bool operator()(const Event& a, const Event& b) const {
+        if (a.time != b.time) return a.time > b.time;
+        if (a.type != b.type) return a.type > b.type;
+        return a.seq > b.seq;
+    }
+};
+
+// Kernel de simulación por eventos discretos: una única cola global ordenada por tiempo.
+// El número de ciclos simulados es el mismo en cada ejecución y el costo en tiempo real
+// depende solo de la cantidad de eventos procesados.
+class Simulator {
+public:
+    explicit Simulator(size_t workerThreads = 1); // Hilos del grupo que ejecuta los PEs lógicos
+
+    void schedule(uint64_t time, EventType type, SimObject* target); // Agenda un evento (nunca en el pasado)
+    void run();                       // Procesa eventos hasta vaciar la cola
+    void runUntil(uint64_t cycle);    // Procesa los eventos anteriores al ciclo indicado
+    bool pending() const;             // Quedan eventos en la cola
+
+    uint64_t now() const;             // Ciclo del evento en proceso
+    uint64_t getProcessedEvents() const;
+    size_t getWorkerThreads() const;
+
+    void setTraceWriter(TraceWriter* writer); // Destino de las trazas de los componentes (nullptr → sin trazas)
+    TraceWriter* getTraceWriter() const;
+
+    RunControl& getRunControl(); // Modo de avance y consola de esta simulación
+    const RunControl& getRunControl() const;
+
+    // Intervalo de medición de la simulación muestreada: solo se registran las latencias de las
+    // solicitudes emitidas en [from, until). Cada ventana detallada lo abre y el primer PE que termina
+    // su ventana lo cierra: desde ahí hay menos solicitudes en vuelo que en la ejecución completa.
+    // Por defecto abarca toda la simulación.
+    void setMeasurement(uint64_t from, uint64_t until);
+    void closeMeasurement(uint64_t cycle);
+    bool measuring(uint64_t cycle) const { return cycle >= measureFrom && cycle < measureUntil; }
+    uint64_t getMeasurementEnd() const;
+
+    // Checkpoint: reloj, contadores y eventos pendientes. Los destinos se guardan como su índice en
+    // objects (la misma tabla al restaurar); loadState reemplaza la cola de eventos.
+    void saveState(CheckpointWriter& out, const std::vector<SimObject*>& objects) const;
+    void loadState(CheckpointReader& in, const std::vector<SimObject*>& objects);
+
+private:
+    WorkerPool workerPool;
+    std::vector<SimObject*> issueBatch; // PEs con eventos del mismo tipo en el ciclo actual
+    uint64_t batchCounter = 0; // Identifica cada lote para no procesar dos veces al mismo PE
+
+    std::priority_queue<Event, std::vector<Event>, CompareEvents> events;
+    uint64_t currentTime = 0;
+    uint64_t nextSeq = 0;
+    uint64_t processedEvents = 0;
+    TraceWriter* traceWriter = nullptr;
+    RunControl runControl;
+    uint64_t measureFrom = 0;
+    uint64_t measureUntil = UINT64_MAX;
+};
+
+#endif // SIMULATOR_HPP
@@ -0,0 +1,100 @@
+#ifndef SPSCQUEUE_HPP
+#define SPSCQUEUE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+// Cola FIFO sin locks de un solo productor y un solo consumidor, sin límite de capacidad.
+// Los elementos viven en segmentos de SEGMENT posiciones enlazados: el productor agrega un segmento
+// cuando llena el actual y el consumidor devuelve el que termina de vaciar como repuesto, así en
+// estado estable no se reserva memoria. El único punto de sincronización es el contador head
+// (release al publicar, acquire al leer); el repuesto se intercambia con un exchange atómico.
+template <typename T, size_t SEGMENT = 64>
+class SpscQueue {
+public:
+    SpscQueue() : writeSegment(new Segment), readSegment(writeSegment) {}
+
+    ~SpscQueue() {
+        while (readSegment) {
+            Segment* next = readSegment->next.load(std::memory_order_relaxed);
+            delete readSegment;
+            readSegment = next;
+        }
+        delete spare.load(std::memory_order_relaxed);
+    }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // Productor
+    void push(T&& value) {
+        uint64_t index = head.load(std::memory_order_relaxed);
+        if (index % SEGMENT == 0 && index != 0) {
+            Segment* segment = spare.exchange(nullptr, std::memory_order_acquire);
+            if (!segment) segment = new Segment;
+            writeSegment->next.store(segment, std::memory_order_relaxed); // Lo publica el release de head
+            writeSegment = segment;
+        }
+        writeSegment->items[index % SEGMENT] = std::move(value);
+        head.store(index + 1, std::memory_order_release);
+    }
+
+    // Consumidor: primer elemento (nullptr si la cola está vacía); sigue en la cola hasta pop()
+    T* front() {
+        if (tail == head.load(std::memory_order_acquire)) return nullptr;
+        if (readOffset == SEGMENT) { // Segmento agotado: el siguiente ya está enlazado porque head > tail
+            Segment* next = readSegment->next.load(std::memory_order_relaxed);
+            recycle(readSegment);
+            readSegment = next;
+            readOffset = 0;
+        }
+        return &readSegment->items[readOffset];
+    }
+
+    // Consumidor: descarta el primer elemento (requiere front() != nullptr)
+    void pop() {
+        tail++;
+        readOffset++;
+    }
+
+    bool empty() const { return tail == head.load(std::memory_order_acquire); } // Solo desde el consumidor
+
+    // Recorre los elementos en orden sin extraerlos (con productor y consumidor detenidos, ej: checkpoint)
+    template <typename Visit>
+    void forEach(Visit visit) const {
+        const Segment* segment = readSegment;
+        size_t offset = readOffset;
+        for (uint64_t i = tail; i < head.load(std::memory_order_acquire); ++i) {
+            if (offset == SEGMENT) {
+                segment = segment->next.load(std::memory_order_relaxed);
+                offset = 0;
+            }
+            visit(segment->items[offset++]);
+        }
+    }
+
+private:
+    struct Segment {
+        T items[SEGMENT];
+        std::atomic<Segment*> next{nullptr};
+    };
+
+    // El segmento vaciado queda como repuesto del productor (si ya había uno, se libera)
+    void recycle(Segment* segment) {
+        segment->next.store(nullptr, std::memory_order_relaxed);
+        delete spare.exchange(segment, std::memory_order_release);
+    }
+
+    alignas(64) std::atomic<uint64_t> head{0}; // Elementos publicados (lo avanza el productor)
+    Segment* writeSegment;                     // Solo del productor
+
+    alignas(64) Segment* readSegment;          // Solo del consumidor
+    uint64_t tail = 0;                         // Elementos consumidos
+    size_t readOffset = 0;                     // Posición de tail en readSegment
+
+    alignas(64) std::atomic<Segment*> spare{nullptr};
+};
+
+#endif // SPSCQUEUE_HPP
@@ -0,0 +1,69 @@
+#ifndef STATS_HPP
+#define STATS_HPP
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "LatencyHistogram.hpp"
+#include "Message.hpp"
+
+class Interconnect;
+class PE;
+class Simulator;
+
+// Cantidad de mensajes y bytes (según messageBytes) por tipo de mensaje
+struct MessageCounters {
+    std::array<uint64_t, MESSAGE_TYPE_COUNT> count{};
+    std::array<uint64_t, MESSAGE_TYPE_COUNT> bytes{};
+
+    void add(const Message& msg) {
+        count[size_t(msg.type)]++;
+        bytes[size_t(msg.type)] += messageBytes(msg);
+    }
+};
+
+// Contadores de un PE. Solo los modifican los eventos del propio PE o el servicio del interconnect,
+// que nunca corren al mismo tiempo: son enteros simples y se suman al final de la ejecución.
+struct PEStats {
+    uint64_t readHits = 0;
+    uint64_t readMisses = 0;             // Incluye los combinados en un MSHR (no los reintentos por MSHRs llenos)
+    uint64_t writes = 0;
+    uint64_t writeHits = 0;              // Con protocolo: escrituras sobre una línea en E o M (sin mensaje)
+    uint64_t writebacks = 0;             // Write-back sin protocolo: líneas sucias enviadas al reemplazarlas
+    uint64_t invalidationFlushes = 0;    // Write-back sin protocolo: líneas sucias propias enviadas antes de su BROADCAST_INVALIDATE
+    uint64_t invalidationsReceived = 0;
+    uint64_t invalidationsUseful = 0;    // La línea estaba en la caché
+    MessageCounters sent;                // Solicitudes al interconnect
+    MessageCounters received;            // Respuestas, acks e INV_COMPLETE
+};
+
+// Contadores del interconnect (se modifican con queueMutex o desde su propio servicio)
+struct InterconnectStats {
+    MessageCounters received;            // Solicitudes de los PEs
+    MessageCounters sent;                // Mensajes entregados a los PEs
+    // Mensajes en el árbitro al encolar cada solicitud (incluida): el histograma de latencias
+    // registra cantidades en lugar de ciclos
+    LatencyHistogram queueOccupancy;
+    uint64_t memoryReads = 0;            // Accesos a la memoria principal
+    uint64_t memoryWrites = 0;           // Incluye los write-backs
+    uint64_t cacheToCacheTransfers = 0;  // Con protocolo: líneas sucias servidas por otra caché
+    uint64_t writebacks = 0;             // Con protocolo: líneas sucias escritas en memoria
+    uint64_t recalledLines = 0;          // Write-back sin protocolo: líneas sucias de otros PEs escritas al invalidarlas
+    uint64_t lineTransferBytes = 0;      // Bytes de las transferencias entre cachés y de los write-backs
+
+    // Tráfico total: mensajes recibidos y enviados más las transferencias de líneas
+    uint64_t trafficBytes() const {
+        uint64_t total = lineTransferBytes;
+        for (size_t type = 0; type < MESSAGE_TYPE_COUNT; ++type) total += received.bytes[type] + sent.bytes[type];
+        return total;
+    }
+};
+
+// Escribe todos los contadores de la ejecución en path: CSV si termina en ".csv", JSON en otro caso.
+// false (con el error en std::cerr) si no se pudo escribir.
+bool writeStats(const std::string& path, const Simulator& simulator, const Interconnect& interconnect,
+                const std::vector<std::unique_ptr<PE>>& pes);
+
+#endif // STATS_HPP
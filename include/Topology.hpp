@@ -0,0 +1,123 @@
+#ifndef TOPOLOGY_HPP
+#define TOPOLOGY_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+class CheckpointReader;
+class CheckpointWriter;
+
+// Topología de la red que une a los PEs con el controlador de memoria
+enum class TopologyType {
+    BUS,     // Bus compartido único (comportamiento original, lo modela el Interconnect)
+    RING,    // Anillo bidireccional, ruta por el sentido más corto
+    MESH,    // Malla 2D con ruteo XY (primero en X, luego en Y)
+    CROSSBAR // Conmutador completo: solo compiten los puertos de origen y destino
+};
+
+bool parseTopology(const std::string& text, TopologyType& type); // "bus" | "ring" | "mesh" | "crossbar"
+const char* topologyName(TopologyType type);
+
+struct TopologyConfig {
+    TopologyType type = TopologyType::BUS;
+    uint32_t linkBytesPerCycle = 8; // Ancho de banda de cada enlace
+    uint32_t hopLatency = 1;        // Ciclos que tarda la cabeza del mensaje en cruzar un enlace
+};
+
+// Red de enlaces punto a punto. Cada nodo tiene un enlace de inyección y uno de extracción y la
+// topología agrega los enlaces entre routers. Un mensaje reserva los enlaces de su ruta en orden
+// (cut-through): cada enlace queda ocupado ceil(bytes / ancho) ciclos desde que la cabeza lo toma,
+// así las transferencias por enlaces disjuntos avanzan al mismo tiempo. Cada enlace guarda sus
+// reservas futuras como intervalos: una transferencia reservada después puede usar un hueco anterior.
+class Topology {
+public:
+    Topology(const TopologyConfig& config, size_t numNodes, size_t routerLinks);
+    virtual ~Topology() = default;
+
+    // Reserva la ruta src -> dst a partir del ciclo start; devuelve el ciclo en que llega el último byte
+    uint64_t transfer(uint16_t src, uint16_t dst, uint32_t bytes, uint64_t start);
+
+    // Ciclo actual de la simulación: las reservas que terminaron antes se descartan
+    void advance(uint64_t now);
+
+    virtual std::string describe() const = 0; // Nombre y dimensiones para el resumen final
+
+    size_t getNumNodes() const;
+    size_t getNumLinks() const;
+    uint64_t getLinkBusyCycles(size_t link) const; // Ciclos de transferencia de un enlace
+    size_t ejectLink(uint16_t node) const;         // Enlace por el que llegan los mensajes al nodo
+    uint64_t getTransfers() const;
+    uint64_t getTotalHops() const;
+
+    // Checkpoint: reservas y contadores de cada enlace (misma topología y cantidad de nodos)
+    void saveState(CheckpointWriter& out) const;
+    void loadState(CheckpointReader& in);
+
+protected:
+    // Agrega a path los enlaces entre routers de src a dst (sin inyección ni extracción)
+    virtual void route(uint16_t src, uint16_t dst, std::vector<uint32_t>& path) const = 0;
+
+    size_t routerLink(size_t index) const { return 2 * numNodes + index; }
+
+    TopologyConfig config;
+    size_t numNodes;
+
+private:
+    struct Reservation {
+        uint64_t start = 0;
+        uint64_t end = 0; // Exclusivo
+    };
+
+    size_t injectLink(uint16_t node) const { return node; }
+    uint64_t reserve(size_t link, uint64_t earliest, uint64_t cycles); // Primer hueco libre desde earliest
+
+    std::vector<std::vector<Reservation>> reservations; // Por enlace, ordenadas, sin solaparse y sin tocarse (se fusionan)
+    std::vector<uint64_t> busyCycles; // Ciclos ocupados por enlace
+    uint64_t currentCycle = 0;
+    std::vector<uint32_t> path;       // Buffer de ruta reutilizado entre transferencias
+    uint64_t transfers = 0;
+    uint64_t totalHops = 0;
+};
+
+// Anillo: nodo i conectado con i+1 e i-1 en ambos sentidos
+class RingTopology : public Topology {
+public:
+    RingTopology(const TopologyConfig& config, size_t numNodes);
+    std::string describe() const override;
+
+protected:
+    void route(uint16_t src, uint16_t dst, std::vector<uint32_t>& path) const override;
+};
+
+// Malla 2D de width x height; el nodo n ocupa la posición (n % width, n / width)
+class MeshTopology : public Topology {
+public:
+    MeshTopology(const TopologyConfig& config, size_t numNodes);
+    std::string describe() const override;
+
+protected:
+    void route(uint16_t src, uint16_t dst, std::vector<uint32_t>& path) const override;
+
+private:
+    enum Direction { EAST, WEST, NORTH, SOUTH };
+    size_t width;
+    size_t height;
+};
+
+// Crossbar: ruta directa del puerto de origen al de destino
+class CrossbarTopology : public Topology {
+public:
+    CrossbarTopology(const TopologyConfig& config, size_t numNodes);
+    std::string describe() const override;
+
+protected:
+    void route(uint16_t src, uint16_t dst, std::vector<uint32_t>& path) const override;
+};
+
+// Crea la red según la configuración; nullptr para BUS (lo modela el Interconnect directamente)
+std::unique_ptr<Topology> makeTopology(const TopologyConfig& config, size_t numNodes);
+
+#endif // TOPOLOGY_HPP
@@ -0,0 +1,41 @@
+#ifndef TRACEREADER_HPP
+#define TRACEREADER_HPP
+
+#include <cstddef>
+#include <string>
+#include "TraceRecord.hpp"
+
+// Lector de trazas binarias (.bin). Mapea el archivo completo con mmap y expone los
+// registros como un arreglo de solo lectura: no copia ni parsea, así que recorrer cientos
+// de millones de eventos cuesta lo mismo que leer la memoria mapeada.
+class TraceReader {
+public:
+    TraceReader() = default;
+    explicit TraceReader(const std::string& path); // Equivale a open(path)
+    ~TraceReader();
+
+    TraceReader(const TraceReader&) = delete;
+    TraceReader& operator=(const TraceReader&) = delete;
+    TraceReader(TraceReader&& other) noexcept;
+    TraceReader& operator=(TraceReader&& other) noexcept;
+
+    bool open(const std::string& path); // false si no existe o el encabezado no es válido (ver error())
+    void close();
+
+    bool isOpen() const;
+    const std::string& error() const;
+
+    size_t size() const;                                 // Cantidad de registros
+    const TraceRecord& operator[](size_t i) const;
+    const TraceRecord* begin() const;
+    const TraceRecord* end() const;
+
+private:
+    void* mapping = nullptr;
+    size_t mappingSize = 0;
+    const TraceRecord* records = nullptr;
+    size_t count = 0;
+    std::string lastError;
+};
+
+#endif // TRACEREADER_HPP
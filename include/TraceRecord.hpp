@@ -0,0 +1,58 @@
+#ifndef TRACERECORD_HPP
+#define TRACERECORD_HPP
+
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include "Message.hpp"
+
+// Extremo de la transferencia tal como aparece en la columna Fuente/Destino
+enum class TracePeer : uint8_t {
+    PE,  // "P<n>"
+    IC,  // "IC"
+    ALL  // "All"
+};
+
+constexpr uint8_t TRACE_OP_UNKNOWN = 0xFF; // Instrucción o respuesta no reconocida
+
+// Registro de traza de tamaño fijo. Es también el registro del formato binario (.bin):
+// 24 bytes en el orden de bytes del host (little-endian en x86/ARM), sin relleno implícito.
+struct TraceRecord {
+    uint64_t cycle = 0;
+    uint32_t addr = 0;
+    uint16_t size = 0;                  // Bytes transferidos
+    uint16_t peer = 0;                  // ID del PE cuando peerKind == PE
+    uint8_t op = TRACE_OP_UNKNOWN;      // MessageType o TRACE_OP_UNKNOWN
+    uint8_t direction = 0;              // 0 → recibido, 1 → enviado
+    TracePeer peerKind = TracePeer::IC;
+    uint8_t reserved[5] = {};           // Siempre en cero
+};
+
+static_assert(sizeof(TraceRecord) == 24, "TraceRecord es el registro del formato binario");
+static_assert(std::is_trivially_copyable_v<TraceRecord>);
+
+// Encabezado de los archivos .bin, seguido de los registros hasta el final del archivo
+struct TraceFileHeader {
+    char magic[8] = {'I', 'C', 'T', 'R', 'A', 'C', 'E', '\0'};
+    uint32_t version = 1;
+    uint32_t recordSize = sizeof(TraceRecord);
+};
+
+static_assert(sizeof(TraceFileHeader) == 16);
+
+// Primera línea de los archivos de texto
+constexpr const char* TRACE_TEXT_HEADER = "Instrucción Recibido/Enviado Tamaño Fuente/Destino Ciclo\n";
+
+inline uint8_t traceOp(MessageType type) {
+    return static_cast<uint8_t>(type);
+}
+
+inline const char* traceOpName(uint8_t op) {
+    if (op == TRACE_OP_UNKNOWN) return "UNKNOWN";
+    return messageTypeName(static_cast<MessageType>(op));
+}
+
+// Agrega la línea de texto del registro: "<op> <dir> <tamaño> <fuente/destino> <ciclo>\n"
+void appendTraceLine(std::string& out, const TraceRecord& rec);
+
+#endif // TRACERECORD_HPP
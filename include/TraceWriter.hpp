@@ -0,0 +1,71 @@
+#ifndef TRACEWRITER_HPP
+#define TRACEWRITER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "TraceRecord.hpp"
+
+// Formato de los archivos de salida
+enum class TraceFormat {
+    TEXT,   // intconnect.txt / peN.txt (el que lee graph.py)
+    BINARY  // intconnect.bin / peN.bin: TraceFileHeader + registros de 24 bytes, se pueden mapear con mmap
+};
+
+bool parseTraceFormat(const std::string& name, TraceFormat& format); // "text" | "binary"
+
+// Escritor asíncrono de los archivos de salida (intconnect y peN, en texto o binario).
+// Cada archivo es un flujo con un anillo sin locks de un solo productor: en cada momento solo
+// un hilo escribe un flujo dado (los eventos de un PE nunca corren en paralelo consigo mismos y
+// el Interconnect corre en el hilo del kernel), así el orden de las líneas se conserva aunque el
+// PE cambie de hilo entre lotes. Un hilo de fondo vacía los anillos, formatea (o copia, en binario)
+// y escribe por bloques.
+class TraceWriter {
+public:
+    static constexpr size_t INTERCONNECT_STREAM = 0;
+    static size_t peStream(uint16_t id) { return size_t(id) + 1; }
+
+    // Trunca los archivos, escribe el encabezado y arranca el hilo escritor
+    TraceWriter(const std::string& outputDir, size_t numPEs, TraceFormat format = TraceFormat::TEXT);
+    ~TraceWriter(); // Equivale a close()
+
+    TraceWriter(const TraceWriter&) = delete;
+    TraceWriter& operator=(const TraceWriter&) = delete;
+
+    // Camino caliente: copia el registro al anillo del flujo (espera solo si el anillo está lleno)
+    void record(size_t stream, const TraceRecord& rec);
+
+    // Detiene el hilo escritor y vuelca todo lo pendiente a disco
+    void close();
+
+    bool ok() const;                       // Todos los archivos se pudieron crear
+    const std::string& failedPath() const; // Primer archivo que no se pudo crear
+
+private:
+    static constexpr size_t RING_CAPACITY = 1024; // Registros por flujo (potencia de dos)
+    static constexpr size_t FLUSH_BYTES = 1 << 16; // Bytes acumulados antes de escribir a disco
+
+    struct Stream {
+        std::unique_ptr<TraceRecord[]> ring;
+        alignas(64) std::atomic<uint64_t> head{0}; // Lo avanza el productor
+        alignas(64) std::atomic<uint64_t> tail{0}; // Lo avanza el hilo escritor
+        std::string path;
+        std::string pending; // Bytes pendientes de escribir (solo los toca el hilo escritor)
+    };
+
+    void writerLoop();
+    bool drain(Stream& stream);  // Formatea los registros disponibles; true si había alguno
+    void flush(Stream& stream);  // Agrega los bytes pendientes al archivo
+
+    TraceFormat format;
+    std::vector<std::unique_ptr<Stream>> streams;
+    std::atomic<bool> running{true};
+    std::thread writer;
+    std::string firstFailure;
+};
+
+#endif // TRACEWRITER_HPP
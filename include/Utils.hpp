@@ -1,5 +0,0 @@
-#pragma once
-#include <thread>
-#include <chrono>
-
-inline void waitUntilReady() { std::this_thread::sleep_for(std::chrono::microseconds(1));}
\ No newline at end of file
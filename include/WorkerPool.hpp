@@ -0,0 +1,54 @@
+#ifndef WORKERPOOL_HPP
+#define WORKERPOOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Grupo fijo de hilos de trabajo. Ejecuta lotes de tareas indexadas [0, count)
+// y bloquea al llamador hasta que el lote completo termina.
+// Permite multiplexar muchos PEs lógicos sobre pocos hilos del sistema operativo.
+class WorkerPool {
+public:
+    explicit WorkerPool(size_t numThreads);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    // Ejecuta task(i) para cada i en [0, count); el hilo llamador también participa.
+    // La tarea se pasa por referencia (puntero a función + contexto): no se copia ni se reserva
+    // memoria en cada lote, por más que capture.
+    template <typename Task>
+    void runBatch(size_t count, const Task& task) {
+        runBatch(count, [](const void* context, size_t i) { (*static_cast<const Task*>(context))(i); }, &task);
+    }
+
+    size_t size() const; // Cantidad de hilos (incluyendo al llamador)
+
+private:
+    using TaskFn = void (*)(const void* context, size_t i);
+
+    void runBatch(size_t count, TaskFn task, const void* context);
+    void workerLoop();
+    void drain(); // Toma tareas del lote actual hasta agotarlas
+
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable startCV;
+    std::condition_variable doneCV;
+
+    std::atomic<TaskFn> currentTask{nullptr};
+    std::atomic<const void*> currentContext{nullptr};
+    std::atomic<size_t> taskCount{0};
+    std::atomic<size_t> nextIndex{0};
+    size_t pending = 0;        // Tareas del lote aún sin terminar
+    size_t active = 0;         // Hilos que están tomando tareas en este momento
+    uint64_t generation = 0;   // Identifica cada lote para despertar a los hilos una sola vez
+    bool stopping = false;
+};
+
+#endif // WORKERPOOL_HPP
@@ -0,0 +1,36 @@
+#ifndef WORKLOADGENERATOR_HPP
+#define WORKLOADGENERATOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "InstructionStream.hpp"
+
+// Patrón de tráfico de los workloads sintéticos
+enum class TrafficPattern {
+    UNIFORM,           // Direcciones uniformes sobre toda la memoria
+    HOTSPOT,           // 80% de los accesos a unas pocas líneas calientes
+    PRODUCER_CONSUMER, // PEs en pares: el par escribe un buffer, el impar lo lee en orden
+    STRIDED,           // Cada PE recorre su región privada con un salto fijo
+    ALL_TO_ALL         // Cada PE escribe su partición y lee las de todos los demás por turnos
+};
+
+bool parseTrafficPattern(const std::string& text, TrafficPattern& pattern); // "uniform" | "hotspot" | ...
+const char* trafficPatternName(TrafficPattern pattern);
+
+struct WorkloadConfig {
+    TrafficPattern pattern = TrafficPattern::UNIFORM;
+    size_t instructions = 1000;   // Instrucciones por PE
+    uint64_t seed = 1;
+    uint64_t memorySize = 16 * 1024;
+    uint32_t lineSize = 16;
+    uint32_t readPercent = 70;    // Porcentaje de lecturas; cada escritura compartida va seguida de su invalidación
+    uint32_t writeBytes = 0;      // Bytes por WRITE_MEM (múltiplo de 4); 0 → la línea completa de una vez
+};
+
+// Genera el programa del PE pe (de numPEs) directamente como InstructionStream, sin archivos de
+// texto. Cada PE usa su propio generador xorshift sembrado con (seed, pe): el resultado es el
+// mismo en cada ejecución y no depende del orden en que se generan los PEs.
+InstructionStream generateWorkload(const WorkloadConfig& config, uint16_t pe, uint16_t numPEs);
+
+#endif // WORKLOADGENERATOR_HPP
@@ -0,0 +1,55 @@
+#ifndef WRITECOMBININGBUFFER_HPP
+#define WRITECOMBININGBUFFER_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "CacheBlock.hpp"
+
+class CheckpointReader;
+class CheckpointWriter;
+
+// Entrada del buffer: bytes escritos de una línea, pendientes de enviar a memoria
+struct WriteCombiningEntry {
+    uint32_t line = 0;  // Dirección del primer byte de la línea
+    uint64_t mask = 0;  // Bit i → byte i de la línea escrito (los tramos salen con forEachByteRun)
+    std::array<uint8_t, CacheBlock::MAX_LINE_SIZE> data = {};
+};
+
+// Buffer de write-combining de un PE (write-through). Las escrituras a una misma línea se combinan en
+// una entrada; la entrada sale como una sola transacción cuando la línea se completa, cuando hace falta
+// su lugar (se reemplaza la más antigua) o cuando se la vacía explícitamente (lectura o invalidación de
+// la línea, fin del programa). Capacidad 0 lo desactiva: cada WRITE_MEM sale por separado.
+class WriteCombiningBuffer {
+public:
+    void configure(size_t entries, uint32_t lineSize);
+    bool enabled() const;
+    bool empty() const;
+
+    // Combina size bytes escritos en addr (puede abarcar varias líneas); las entradas que deben
+    // salir se agregan a `flushed`
+    void write(uint32_t addr, const uint8_t* data, size_t size, std::vector<WriteCombiningEntry>& flushed);
+    bool drain(uint32_t addr, std::vector<WriteCombiningEntry>& flushed); // La entrada de la línea de addr, si está
+    void drainAll(std::vector<WriteCombiningEntry>& flushed);              // Todas, de la más antigua a la más nueva
+
+    // Estadísticas
+    uint64_t getCombinedWrites() const; // Escrituras absorbidas por una entrada que ya existía
+    uint64_t getFullLines() const;      // Entradas que salieron con la línea completa
+
+    void saveState(CheckpointWriter& out) const; // Checkpoint: entradas pendientes y estadísticas
+    void loadState(CheckpointReader& in);
+
+private:
+    void flushOldest(std::vector<WriteCombiningEntry>& flushed);
+
+    size_t capacity = 0;
+    uint32_t lineSize = 16;
+    uint64_t fullMask = 0;
+    std::vector<WriteCombiningEntry> entries; // En orden de llegada (la más antigua primero)
+
+    uint64_t combinedWrites = 0;
+    uint64_t fullLines = 0;
+};
+
+#endif // WRITECOMBININGBUFFER_HPP
@@ -0,0 +1,243 @@
+#include "Arbiter.hpp"
+#include <algorithm>
+#include "Checkpoint.hpp"
+
+// -------------------- FIFO --------------------
+
+void FifoArbiter::push(const Message& msg) {
+    fifoMessageQueue.push(msg);
+}
+
+void FifoArbiter::push(Message&& msg) {
+    fifoMessageQueue.push(std::move(msg));
+}
+
+Message FifoArbiter::pop() {
+    return fifoMessageQueue.pop();
+}
+
+bool FifoArbiter::empty() const {
+    return fifoMessageQueue.empty();
+}
+
+size_t FifoArbiter::size() const {
+    return fifoMessageQueue.size();
+}
+
+void FifoArbiter::saveState(CheckpointWriter& out) const {
+    out.put<uint64_t>(fifoMessageQueue.size());
+    for (size_t i = 0; i < fifoMessageQueue.size(); ++i) out.putMessage(fifoMessageQueue.at(i));
+}
+
+void FifoArbiter::loadState(CheckpointReader& in) {
+    uint64_t count = in.get<uint64_t>();
+    for (uint64_t i = 0; i < count && in.ok(); ++i) {
+        Message msg;
+        in.getMessage(msg);
+        fifoMessageQueue.push(std::move(msg));
+    }
+}
+
+// -------------------- Prioridad --------------------
+
+PriorityArbiter::PriorityArbiter(uint64_t agingGrants)
+    : agingGrants(agingGrants) {}
+
+void PriorityArbiter::push(const Message& msg) {
+    push(Message(msg));
+}
+
+void PriorityArbiter::push(Message&& msg) {
+    uint64_t key = agingGrants ? uint64_t(msg.qos) * agingGrants + grants : msg.qos;
+    priorityMessageQueue.push_back(PrioritizedMessage{key, nextSeq++, std::move(msg)});
+    std::push_heap(priorityMessageQueue.begin(), priorityMessageQueue.end(), CompareMessages());
+}
+
+Message PriorityArbiter::pop() {
+    std::pop_heap(priorityMessageQueue.begin(), priorityMessageQueue.end(), CompareMessages());
+    Message msg = std::move(priorityMessageQueue.back().msg);
+    priorityMessageQueue.pop_back();
+    grants++;
+    return msg;
+}
+
+bool PriorityArbiter::empty() const {
+    return priorityMessageQueue.empty();
+}
+
+size_t PriorityArbiter::size() const {
+    return priorityMessageQueue.size();
+}
+
+// El heap se guarda en el orden del vector: al leerlo en el mismo orden sigue siendo un heap válido
+void PriorityArbiter::saveState(CheckpointWriter& out) const {
+    out.put(grants);
+    out.put(nextSeq);
+    out.put<uint64_t>(priorityMessageQueue.size());
+    for (const PrioritizedMessage& entry : priorityMessageQueue) {
+        out.put(entry.key);
+        out.put(entry.seq);
+        out.putMessage(entry.msg);
+    }
+}
+
+void PriorityArbiter::loadState(CheckpointReader& in) {
+    in.get(grants);
+    in.get(nextSeq);
+    uint64_t count = in.get<uint64_t>();
+    priorityMessageQueue.clear();
+    for (uint64_t i = 0; i < count && in.ok(); ++i) {
+        PrioritizedMessage entry{};
+        in.get(entry.key);
+        in.get(entry.seq);
+        in.getMessage(entry.msg);
+        priorityMessageQueue.push_back(std::move(entry));
+    }
+}
+
+// -------------------- Turnos por PE --------------------
+
+uint64_t RoundRobinArbiter::weight(uint8_t qos) {
+    return qos < MAX_WEIGHT ? MAX_WEIGHT - qos : 1;
+}
+
+RoundRobinArbiter::Flow& RoundRobinArbiter::flowOf(uint16_t src) {
+    if (src >= flows.size()) flows.resize(size_t(src) + 1);
+    return flows[src];
+}
+
+void RoundRobinArbiter::push(const Message& msg) {
+    push(Message(msg));
+}
+
+void RoundRobinArbiter::push(Message&& msg) {
+    uint16_t src = msg.src;
+    Flow& flow = flowOf(src);
+    flow.queue.push(std::move(msg));
+    if (!flow.active) {
+        flow.active = true;
+        round.push(src);
+    }
+    count++;
+}
+
+Message RoundRobinArbiter::take(uint16_t id) {
+    Flow& flow = flows[id];
+    Message msg = flow.queue.pop();
+    count--;
+    if (flow.queue.empty()) {
+        flow.credit = 0;
+        flow.inTurn = false;
+        flow.active = false;
+        round.pop();
+    }
+    return msg;
+}
+
+void RoundRobinArbiter::rotate() {
+    uint16_t id = round.pop();
+    flows[id].inTurn = false;
+    round.push(id);
+}
+
+bool RoundRobinArbiter::empty() const {
+    return count == 0;
+}
+
+size_t RoundRobinArbiter::size() const {
+    return count;
+}
+
+void RoundRobinArbiter::saveState(CheckpointWriter& out) const {
+    out.put<uint64_t>(flows.size());
+    for (const Flow& flow : flows) {
+        out.put<uint64_t>(flow.queue.size());
+        for (size_t i = 0; i < flow.queue.size(); ++i) out.putMessage(flow.queue.at(i));
+        out.put(flow.credit);
+        out.put(uint8_t(flow.inTurn));
+        out.put(uint8_t(flow.active));
+    }
+    out.put<uint64_t>(round.size());
+    for (size_t i = 0; i < round.size(); ++i) out.put(round.at(i));
+}
+
+void RoundRobinArbiter::loadState(CheckpointReader& in) {
+    uint64_t numFlows = in.get<uint64_t>();
+    if (numFlows > 0x10000) in.fail();
+    if (!in.ok()) return;
+    flows.resize(size_t(numFlows));
+    count = 0;
+    for (Flow& flow : flows) {
+        uint64_t queued = in.get<uint64_t>();
+        for (uint64_t i = 0; i < queued && in.ok(); ++i) {
+            Message msg;
+            in.getMessage(msg);
+            flow.queue.push(std::move(msg));
+        }
+        count += size_t(queued);
+        in.get(flow.credit);
+        flow.inTurn = in.get<uint8_t>() != 0;
+        flow.active = in.get<uint8_t>() != 0;
+    }
+    uint64_t turns = in.get<uint64_t>();
+    for (uint64_t i = 0; i < turns && in.ok(); ++i) {
+        uint16_t id = in.get<uint16_t>();
+        if (id >= flows.size()) in.fail();
+        round.push(id);
+    }
+}
+
+// -------------------- WRR --------------------
+
+Message WeightedRoundRobinArbiter::pop() {
+    uint16_t id = round.front();
+    Flow& flow = flows[id];
+    if (!flow.inTurn) {
+        flow.credit = weight(flow.queue.front().qos);
+        flow.inTurn = true;
+    }
+    flow.credit--;
+    bool turnOver = flow.credit == 0;
+    Message msg = take(id);
+    if (turnOver && flow.active) rotate();
+    return msg;
+}
+
+// -------------------- DRR --------------------
+
+Message DeficitRoundRobinArbiter::pop() {
+    for (;;) {
+        uint16_t id = round.front();
+        Flow& flow = flows[id];
+        if (!flow.inTurn) {
+            flow.credit += weight(flow.queue.front().qos) * DRR_QUANTUM;
+            flow.inTurn = true;
+        }
+        uint64_t cost = messageBytes(flow.queue.front());
+        if (cost <= flow.credit) {
+            flow.credit -= cost;
+            return take(id);
+        }
+        rotate(); // El crédito no alcanza: lo conserva para el próximo turno
+    }
+}
+
+std::unique_ptr<Arbiter> makeArbiter(int executionMode) {
+    switch (executionMode) {
+        case 1: return std::make_unique<PriorityArbiter>();
+        case 2: return std::make_unique<WeightedRoundRobinArbiter>();
+        case 3: return std::make_unique<DeficitRoundRobinArbiter>();
+        case 4: return std::make_unique<PriorityArbiter>(AGING_GRANTS);
+        default: return std::make_unique<FifoArbiter>();
+    }
+}
+
+const char* arbiterName(int executionMode) {
+    switch (executionMode) {
+        case 1: return "Prioridad";
+        case 2: return "Weighted Round-Robin";
+        case 3: return "Deficit Round-Robin";
+        case 4: return "Prioridad con envejecimiento";
+        default: return "FIFO";
+    }
+}
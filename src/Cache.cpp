@@ -0,0 +1,220 @@
+#include "Cache.hpp"
+#include <algorithm>
+#include "Checkpoint.hpp"
+
+static bool isPowerOfTwo(size_t value) {
+    return value != 0 && (value & (value - 1)) == 0;
+}
+
+std::string cacheConfigError(const CacheConfig& config) {
+    if (!isPowerOfTwo(config.lineSize) || config.lineSize > CacheBlock::MAX_LINE_SIZE) {
+        return "El tamaño de línea debe ser potencia de 2 y a lo sumo " + std::to_string(CacheBlock::MAX_LINE_SIZE) + " bytes.";
+    }
+    if (!isPowerOfTwo(config.associativity) || config.associativity > 64) {
+        return "La asociatividad debe ser potencia de 2 entre 1 y 64.";
+    }
+    size_t setBytes = config.lineSize * config.associativity;
+    if (config.sizeBytes < setBytes || config.sizeBytes % setBytes != 0) {
+        return "El tamaño de la caché debe ser múltiplo de (tamaño de línea x asociatividad).";
+    }
+    return "";
+}
+
+bool parseReplacementPolicy(const std::string& text, ReplacementPolicy& policy) {
+    if (text == "lru") policy = ReplacementPolicy::LRU;
+    else if (text == "plru") policy = ReplacementPolicy::PLRU;
+    else if (text == "random") policy = ReplacementPolicy::RANDOM;
+    else return false;
+    return true;
+}
+
+bool parseWritePolicy(const std::string& text, WritePolicy& policy) {
+    if (text == "through") policy = WritePolicy::WRITE_THROUGH;
+    else if (text == "back") policy = WritePolicy::WRITE_BACK;
+    else return false;
+    return true;
+}
+
+Cache::Cache(const CacheConfig& config, uint32_t seed)
+    : config(config),
+      numSets(config.sizeBytes / (config.lineSize * config.associativity)),
+      lineShift(__builtin_ctzll(config.lineSize)),
+      blocks(numSets * config.associativity),
+      lastUse(numSets * config.associativity, 0),
+      plruBits(numSets, 0),
+      rngState(0x9E3779B97F4A7C15ull ^ (uint64_t(seed) + 1)) // Semilla distinta por PE, misma en cada ejecución
+{}
+
+uint32_t Cache::lineOf(uint32_t addr) const {
+    return addr >> lineShift;
+}
+
+uint32_t Cache::offsetOf(uint32_t addr) const {
+    return addr & uint32_t(config.lineSize - 1);
+}
+
+size_t Cache::setOf(uint32_t addr) const {
+    return lineOf(addr) % numSets;
+}
+
+const CacheConfig& Cache::getConfig() const {
+    return config;
+}
+
+size_t Cache::getNumSets() const {
+    return numSets;
+}
+
+// Busca la etiqueta en las vías del conjunto
+CacheBlock* Cache::find(size_t set, uint32_t tag, size_t& way) {
+    CacheBlock* base = &blocks[set * config.associativity];
+    for (way = 0; way < config.associativity; ++way) {
+        if (base[way].valid() && base[way].tag == tag) return &base[way];
+    }
+    return nullptr;
+}
+
+CacheBlock* Cache::lookup(uint32_t addr) {
+    size_t set = setOf(addr);
+    size_t way;
+    CacheBlock* block = find(set, lineOf(addr), way);
+    if (block) touch(set, way);
+    return block;
+}
+
+CacheBlock* Cache::probe(uint32_t addr) {
+    size_t way;
+    return find(setOf(addr), lineOf(addr), way);
+}
+
+CacheBlock& Cache::allocate(uint32_t addr) {
+    CacheBlock evicted;
+    return allocate(addr, evicted);
+}
+
+CacheBlock& Cache::allocate(uint32_t addr, CacheBlock& evicted) {
+    size_t set = setOf(addr);
+    uint32_t tag = lineOf(addr);
+    size_t way;
+    CacheBlock* block = find(set, tag, way);
+    evicted.state = CoherenceState::INVALID;
+
+    if (!block) {
+        way = victim(set);
+        block = &blocks[set * config.associativity + way];
+        if (block->valid()) evicted = *block;
+        *block = CacheBlock{};
+        block->tag = tag;
+    }
+    touch(set, way);
+    return *block;
+}
+
+bool Cache::invalidate(uint32_t addr) {
+    size_t way;
+    CacheBlock* block = find(setOf(addr), lineOf(addr), way);
+    if (!block) return false;
+    block->state = CoherenceState::INVALID;
+    return true;
+}
+
+void Cache::touch(size_t set, size_t way) {
+    switch (config.policy) {
+        case ReplacementPolicy::LRU:
+            lastUse[set * config.associativity + way] = ++useCounter;
+            break;
+        case ReplacementPolicy::PLRU: {
+            // Recorre el árbol desde la raíz dejando cada nodo apuntando a la mitad que NO contiene la vía usada
+            uint64_t& bits = plruBits[set];
+            size_t node = 0, low = 0, span = config.associativity;
+            while (span > 1) {
+                span /= 2;
+                if (way >= low + span) {
+                    bits &= ~(uint64_t(1) << node); // Víctima futura: mitad izquierda
+                    node = 2 * node + 2;
+                    low += span;
+                } else {
+                    bits |= uint64_t(1) << node;    // Víctima futura: mitad derecha
+                    node = 2 * node + 1;
+                }
+            }
+            break;
+        }
+        case ReplacementPolicy::RANDOM:
+            break;
+    }
+}
+
+size_t Cache::victim(size_t set) {
+    // Primero se usa cualquier vía inválida
+    const CacheBlock* base = &blocks[set * config.associativity];
+    for (size_t way = 0; way < config.associativity; ++way) {
+        if (!base[way].valid()) return way;
+    }
+
+    switch (config.policy) {
+        case ReplacementPolicy::LRU: {
+            const uint64_t* uses = &lastUse[set * config.associativity];
+            return size_t(std::min_element(uses, uses + config.associativity) - uses);
+        }
+        case ReplacementPolicy::PLRU: {
+            uint64_t bits = plruBits[set];
+            size_t node = 0, low = 0, span = config.associativity;
+            while (span > 1) {
+                span /= 2;
+                if ((bits >> node) & 1) {
+                    node = 2 * node + 2;
+                    low += span;
+                } else {
+                    node = 2 * node + 1;
+                }
+            }
+            return low;
+        }
+        case ReplacementPolicy::RANDOM: {
+            rngState ^= rngState << 13;
+            rngState ^= rngState >> 7;
+            rngState ^= rngState << 17;
+            return size_t(rngState % config.associativity);
+        }
+    }
+    return 0;
+}
+
+void Cache::saveState(CheckpointWriter& out) const {
+    out.put<uint64_t>(blocks.size());
+    for (const CacheBlock& block : blocks) {
+        out.put(uint8_t(block.state));
+        if (!block.valid()) continue;
+        out.put(block.tag);
+        out.put(block.readyCycle);
+        out.put(block.dirtyMask);
+        out.putBytes(block.data.data(), config.lineSize);
+    }
+    out.putVector(lastUse);
+    out.putVector(plruBits);
+    out.put(useCounter);
+    out.put(rngState);
+}
+
+void Cache::loadState(CheckpointReader& in) {
+    if (in.get<uint64_t>() != blocks.size()) in.fail();
+    if (!in.ok()) return;
+    for (CacheBlock& block : blocks) {
+        block = CacheBlock{};
+        uint8_t state = in.get<uint8_t>();
+        if (state > uint8_t(CoherenceState::MODIFIED)) in.fail();
+        block.state = CoherenceState(state);
+        if (!block.valid()) continue;
+        in.get(block.tag);
+        in.get(block.readyCycle);
+        in.get(block.dirtyMask);
+        in.getBytes(block.data.data(), config.lineSize);
+    }
+    size_t ways = lastUse.size(), sets = plruBits.size();
+    in.getVector(lastUse);
+    in.getVector(plruBits);
+    if (lastUse.size() != ways || plruBits.size() != sets) in.fail();
+    in.get(useCounter);
+    in.get(rngState);
+}
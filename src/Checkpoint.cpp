@@ -0,0 +1,131 @@
+#include "Checkpoint.hpp"
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+void CheckpointWriter::putBytes(const void* data, size_t size) {
+    if (size == 0) return; // Un contenedor vacío puede tener data() nulo
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    buffer.insert(buffer.end(), bytes, bytes + size);
+}
+
+void CheckpointWriter::putString(const std::string& text) {
+    put<uint64_t>(text.size());
+    putBytes(text.data(), text.size());
+}
+
+void CheckpointWriter::putMessage(const Message& msg) {
+    put(uint8_t(msg.type));
+    put(msg.src);
+    put(msg.dest);
+    put(msg.addr);
+    put(msg.size);
+    put(msg.qos);
+    put(uint8_t(msg.status));
+    put(msg.cycle);
+    put(uint8_t(msg.data.size()));
+    putBytes(msg.data.data(), msg.data.size());
+}
+
+bool CheckpointWriter::save(const std::string& path) const {
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        std::cerr << "ERROR: No se pudo crear el checkpoint " << path << "\n";
+        return false;
+    }
+    CheckpointHeader header;
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+              std::fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size();
+    ok = std::fclose(file) == 0 && ok;
+    if (!ok) std::cerr << "ERROR: No se pudo escribir el checkpoint " << path << "\n";
+    return ok;
+}
+
+size_t CheckpointWriter::size() const {
+    return buffer.size();
+}
+
+bool CheckpointReader::load(const std::string& path) {
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        std::cerr << "ERROR: No se pudo abrir el checkpoint " << path << "\n";
+        return false;
+    }
+    CheckpointHeader header, expected;
+    bool ok = std::fread(&header, sizeof(header), 1, file) == 1 &&
+              std::memcmp(header.magic, expected.magic, sizeof(header.magic)) == 0;
+    if (!ok || header.version != expected.version) {
+        std::fclose(file);
+        std::cerr << "ERROR: " << path << " no es un checkpoint compatible (versión " << expected.version << ")\n";
+        return false;
+    }
+
+    std::fseek(file, 0, SEEK_END);
+    long end = std::ftell(file);
+    std::fseek(file, long(sizeof(header)), SEEK_SET);
+    buffer.resize(end > long(sizeof(header)) ? size_t(end) - sizeof(header) : 0);
+    ok = std::fread(buffer.data(), 1, buffer.size(), file) == buffer.size();
+    std::fclose(file);
+    if (!ok) {
+        std::cerr << "ERROR: No se pudo leer el checkpoint " << path << "\n";
+        return false;
+    }
+    position = 0;
+    failed = false;
+    return true;
+}
+
+void CheckpointReader::getBytes(void* data, size_t size) {
+    if (size == 0) return; // Un contenedor vacío puede tener data() nulo (memcpy/memset no lo admiten)
+    if (failed || size > remaining()) {
+        failed = true;
+        std::memset(data, 0, size);
+        return;
+    }
+    std::memcpy(data, buffer.data() + position, size);
+    position += size;
+}
+
+void CheckpointReader::getString(std::string& text) {
+    uint64_t size = get<uint64_t>();
+    if (size > remaining()) {
+        fail();
+        return;
+    }
+    text.assign(reinterpret_cast<const char*>(buffer.data() + position), size);
+    position += size;
+}
+
+void CheckpointReader::getMessage(Message& msg) {
+    msg.type = MessageType(get<uint8_t>());
+    get(msg.src);
+    get(msg.dest);
+    get(msg.addr);
+    get(msg.size);
+    get(msg.qos);
+    msg.status = get<uint8_t>() != 0;
+    get(msg.cycle);
+    size_t length = get<uint8_t>();
+    if (size_t(msg.type) >= MESSAGE_TYPE_COUNT || length > Payload::CAPACITY) {
+        fail();
+        return;
+    }
+    msg.data.resize(length);
+    getBytes(msg.data.data(), length);
+}
+
+void CheckpointReader::fail() {
+    failed = true;
+}
+
+bool CheckpointReader::ok() const {
+    return !failed;
+}
+
+bool CheckpointReader::atEnd() const {
+    return position == buffer.size();
+}
+
+size_t CheckpointReader::remaining() const {
+    return buffer.size() - position;
+}
@@ -0,0 +1,18 @@
+#include "Coherence.hpp"
+
+bool parseCoherenceProtocol(const std::string& text, CoherenceProtocol& protocol) {
+    if (text == "none") protocol = CoherenceProtocol::NONE;
+    else if (text == "mesi") protocol = CoherenceProtocol::MESI;
+    else if (text == "moesi") protocol = CoherenceProtocol::MOESI;
+    else return false;
+    return true;
+}
+
+const char* coherenceProtocolName(CoherenceProtocol protocol) {
+    switch (protocol) {
+        case CoherenceProtocol::NONE:  return "none";
+        case CoherenceProtocol::MESI:  return "MESI";
+        case CoherenceProtocol::MOESI: return "MOESI";
+    }
+    return "?";
+}
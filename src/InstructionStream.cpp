@@ -0,0 +1,183 @@
+#include "InstructionStream.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+const char* opcodeName(Opcode op) {
+    switch (op) {
+        case Opcode::READ_MEM:             return "READ_MEM";
+        case Opcode::WRITE_MEM:            return "WRITE_MEM";
+        case Opcode::BROADCAST_INVALIDATE: return "BROADCAST_INVALIDATE";
+        case Opcode::UNKNOWN:              break;
+    }
+    return "UNKNOWN";
+}
+
+namespace {
+
+bool isBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+// Siguiente token separado por blancos; avanza pos
+bool nextToken(const char*& pos, const char* end, const char*& tokenBegin, const char*& tokenEnd) {
+    while (pos < end && isBlank(*pos)) ++pos;
+    if (pos == end) return false;
+    tokenBegin = pos;
+    while (pos < end && !isBlank(*pos)) ++pos;
+    tokenEnd = pos;
+    return true;
+}
+
+bool tokenEquals(const char* begin, const char* end, const char* word) {
+    size_t length = std::strlen(word);
+    return size_t(end - begin) == length && std::memcmp(begin, word, length) == 0;
+}
+
+// Entero en hexadecimal con prefijo 0x opcional (como std::stoul(..., 16)); false si no es válido
+bool parseHex(const char* begin, const char* end, uint32_t& value) {
+    if (end - begin > 2 && begin[0] == '0' && (begin[1] == 'x' || begin[1] == 'X')) begin += 2;
+    if (begin == end) return false;
+    uint64_t result = 0;
+    for (const char* p = begin; p < end; ++p) {
+        unsigned digit;
+        if (*p >= '0' && *p <= '9') digit = unsigned(*p - '0');
+        else if (*p >= 'a' && *p <= 'f') digit = unsigned(*p - 'a' + 10);
+        else if (*p >= 'A' && *p <= 'F') digit = unsigned(*p - 'A' + 10);
+        else return false;
+        result = (result << 4) | digit;
+        if (result > UINT32_MAX) return false;
+    }
+    value = uint32_t(result);
+    return true;
+}
+
+bool parseDecimal(const char* begin, const char* end, uint32_t& value) {
+    if (begin == end) return false;
+    uint64_t result = 0;
+    for (const char* p = begin; p < end; ++p) {
+        if (*p < '0' || *p > '9') return false;
+        result = result * 10 + unsigned(*p - '0');
+        if (result > UINT32_MAX) return false;
+    }
+    value = uint32_t(result);
+    return true;
+}
+
+} // namespace
+
+bool InstructionStream::load(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        ::close(fd);
+        return false;
+    }
+
+    size_t fileSize = size_t(info.st_size);
+    if (fileSize == 0) { // mmap no acepta tamaño 0: programa vacío
+        ::close(fd);
+        parse(nullptr, nullptr);
+        return true;
+    }
+    void* data = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // El mapeo sigue siendo válido sin el descriptor
+    if (data == MAP_FAILED) return false;
+    madvise(data, fileSize, MADV_SEQUENTIAL);
+
+    const char* text = static_cast<const char*>(data);
+    parse(text, text + fileSize);
+    munmap(data, fileSize);
+    return true;
+}
+
+void InstructionStream::parse(const char* begin, const char* end) {
+    opcodes.clear();
+    addrs.clear();
+    operands.clear();
+    unknownLines.clear();
+    if (begin == end) return;
+
+    // Se reserva una vez según la cantidad de líneas
+    size_t lines = size_t(std::count(begin, end, '\n')) + (end[-1] != '\n' ? 1 : 0);
+    opcodes.reserve(lines);
+    addrs.reserve(lines);
+    operands.reserve(lines);
+
+    const char* line = begin;
+    while (line < end) {
+        const char* newline = static_cast<const char*>(std::memchr(line, '\n', size_t(end - line)));
+        const char* lineEnd = newline ? newline : end;
+        decodeLine(line, lineEnd);
+        line = lineEnd + 1;
+    }
+}
+
+// Una línea del workload es una instrucción, igual que con std::getline (las líneas vacías o
+// inválidas quedan como UNKNOWN y se informan al ejecutarse)
+void InstructionStream::decodeLine(const char* begin, const char* end) {
+    const char* pos = begin;
+    const char* tokenBegin;
+    const char* tokenEnd;
+    Opcode op = Opcode::UNKNOWN;
+    uint32_t addr = 0;
+    uint32_t operand = 0;
+
+    if (nextToken(pos, end, tokenBegin, tokenEnd)) {
+        const char* opBegin = tokenBegin;
+        const char* opEnd = tokenEnd;
+        bool hasAddr = nextToken(pos, end, tokenBegin, tokenEnd) && parseHex(tokenBegin, tokenEnd, addr);
+
+        if (tokenEquals(opBegin, opEnd, "READ_MEM") || tokenEquals(opBegin, opEnd, "WRITE_MEM")) {
+            if (hasAddr && nextToken(pos, end, tokenBegin, tokenEnd) && parseDecimal(tokenBegin, tokenEnd, operand)) {
+                op = opBegin[0] == 'R' ? Opcode::READ_MEM : Opcode::WRITE_MEM;
+            }
+        } else if (tokenEquals(opBegin, opEnd, "BROADCAST_INVALIDATE")) {
+            if (hasAddr) op = Opcode::BROADCAST_INVALIDATE;
+        }
+    }
+
+    if (op == Opcode::UNKNOWN) {
+        addr = uint32_t(unknownLines.size());
+        operand = 0;
+        const char* trimmed = end;
+        if (trimmed > begin && trimmed[-1] == '\r') --trimmed;
+        unknownLines.emplace_back(begin, trimmed);
+    }
+    opcodes.push_back(op);
+    addrs.push_back(addr);
+    operands.push_back(operand);
+}
+
+void InstructionStream::append(Opcode op, uint32_t addr, uint32_t operand) {
+    opcodes.push_back(op);
+    addrs.push_back(addr);
+    operands.push_back(operand);
+}
+
+void InstructionStream::reserve(size_t instructions) {
+    opcodes.reserve(instructions);
+    addrs.reserve(instructions);
+    operands.reserve(instructions);
+}
+
+std::string InstructionStream::text(size_t i) const {
+    char hex[16];
+    switch (opcodes[i]) {
+        case Opcode::READ_MEM:
+        case Opcode::WRITE_MEM:
+            std::snprintf(hex, sizeof(hex), "0x%X", addrs[i]);
+            return std::string(opcodeName(opcodes[i])) + " " + hex + " " + std::to_string(operands[i]);
+        case Opcode::BROADCAST_INVALIDATE:
+            std::snprintf(hex, sizeof(hex), "0x%X", addrs[i]);
+            return std::string(opcodeName(opcodes[i])) + " " + hex;
+        case Opcode::UNKNOWN:
+            break;
+    }
+    return unknownLines[addrs[i]];
+}
@@ -1,277 +1,1097 @@
 #include "Interconnect.hpp" // Incluye el archivo de encabezado de la clase Interconnect
-#include "Utils.hpp"          // Archivo Funciones Adicionales
 #include <iostream>         // Para entrada/salida estándar (cout)
 #include <mutex>            // Para la exclusión mutua al imprimir
-#include <queue>            // Para la cola de prioridad
-#include <vector>           // Para usar std::vector en la cola FIFO
-#include <algorithm>        // Para std::sort en la cola de prioridad
-#include <fstream>
-
-extern std::mutex cout_mutex; // Mutex global definido en main.cpp
-extern std::mutex cin_mutex; // Mutex global definido en main.cpp
-extern std::mutex execution; // Mutex global definido en main.cpp
-extern int executionMode; // Modo de ejecución (0 -> FIFO, 1 -> Prioridad)
-
-// Constructor por defecto de la clase Interconnect
-Interconnect::Interconnect()
-    : outputPath("../output/intconnect.txt")
+#include <algorithm>        // Para std::max
+#include <array>
+#include "Checkpoint.hpp"
+
+bool parseBusMode(const std::string& text, BusMode& mode) {
+    if (text == "atomic") mode = BusMode::ATOMIC;
+    else if (text == "split") mode = BusMode::SPLIT;
+    else return false;
+    return true;
+}
+
+// Constructor de la clase Interconnect
+Interconnect::Interconnect(Simulator* simulator, int arbiterMode)
+    : simulator(simulator),
+      arbiter(makeArbiter(arbiterMode)) // La política de arbitraje depende del modo de ejecución
 {}
 
-// Destructor de la clase Interconnect
-Interconnect::~Interconnect() {
-    stop(); // Llama al método stop para asegurar que el thread worker termine correctamente
+// Método para enviar un mensaje al Interconnect
+void Interconnect::sendMessage(const Message& msg) {
+    sendMessage(Message(msg));
 }
 
-// Método para iniciar el Interconnect
-void Interconnect::start() {
-    running = true;                                     // Marca el Interconnect como en ejecución
-    worker = std::thread(&Interconnect::processLoop, this); // Crea un nuevo thread que ejecuta el método processLoop de este objeto Interconnect
+// Variante por movimiento: el mensaje pasa a la cola del árbitro sin copias adicionales
+void Interconnect::sendMessage(Message&& msg) {
+    std::lock_guard<std::mutex> lock(queueMutex); // Adquiere un lock del mutex para proteger el acceso a la cola de mensajes
+    uint64_t issueCycle = msg.cycle;
+    stats.received.add(msg);
+
+    // En una red la solicitud primero viaja hasta el controlador; se arbitra recién al llegar
+    if (topology) {
+        topology->advance(issueCycle);
+        NetworkArrival pending;
+        pending.arrival = topology->transfer(msg.src, memoryNode, messageBytes(msg), issueCycle);
+        pending.seq = nextPendingSeq++;
+        pending.msg = std::move(msg);
+        requestService(pending.arrival);
+        networkArrivals.push_back(std::move(pending));
+        std::push_heap(networkArrivals.begin(), networkArrivals.end(), CompareArrival());
+        return;
+    }
+
+    arbiter->push(std::move(msg));
+    stats.queueOccupancy.record(arbiter->size());
+
+    // Si el bus no tiene un servicio pendiente, se agenda para cuando quede libre
+    if (busMode == BusMode::ATOMIC || inFlight < maxInFlight) {
+        requestService(std::max(clockCycle, issueCycle));
+    }
 }
 
-// Método para detener el Interconnect
-void Interconnect::stop() {
-    running = false;                               // Marca el Interconnect como no en ejecución
+// Método para registrar un PE en el Interconnect
+void Interconnect::registerPE(uint16_t id, PE* pe) {
+    if (id >= peDirectory.size()) {
+        peDirectory.resize(id + 1, nullptr);
+        latencies.resize(id + 1);
+        scheduledDelivery.resize(id + 1, NO_SERVICE);
+    }
+    peDirectory[id] = pe; // Asocia el ID del PE con un puntero al objeto PE en el directorio de PEs
+    pe->setCoherenceProtocol(protocol);
+}
 
-    if (worker.joinable()) { // Verifica si el thread worker puede ser unido (si aún no ha terminado)
-        worker.join();       // Espera a que el thread worker termine su ejecución
+void Interconnect::setCoherenceMode(CoherenceMode mode) {
+    coherenceMode = mode;
+}
+
+void Interconnect::setLineSize(uint32_t size) {
+    lineSize = size;
+    sharerDirectory.setLineSize(size);
+}
+
+void Interconnect::setCoherenceProtocol(CoherenceProtocol protocol) {
+    this->protocol = protocol;
+    for (PE* pe : peDirectory) {
+        if (pe) pe->setCoherenceProtocol(protocol);
     }
 }
 
-// Método para enviar un mensaje al Interconnect
-void Interconnect::sendMessage(const Message& msg) {
+CoherenceProtocol Interconnect::getCoherenceProtocol() const {
+    return protocol;
+}
+
+size_t Interconnect::writeBackCaches() {
+    size_t lines = 0;
+    for (PE* pe : peDirectory) {
+        if (pe) lines += pe->writeBackDirtyLines(mainMemory);
+    }
+    return lines;
+}
+
+uint64_t Interconnect::getInvalidationsSent() const {
+    return invalidationsSent;
+}
+
+uint64_t Interconnect::getInvalidationsAvoided() const {
+    return invalidationsAvoided;
+}
+
+MainMemory& Interconnect::getMainMemory() {
+    return mainMemory;
+}
+
+void Interconnect::setBusMode(BusMode mode, size_t maxInFlight) {
+    busMode = mode;
+    this->maxInFlight = std::max<size_t>(maxInFlight, 1);
+}
+
+void Interconnect::setTopology(const TopologyConfig& config) {
+    BytesForCicle = int(std::max<uint32_t>(config.linkBytesPerCycle, 1)); // El bus usa el mismo ancho de banda
+    memoryNode = uint16_t(peDirectory.size());
+    topology = makeTopology(config, peDirectory.size() + 1);
+}
+
+const Topology* Interconnect::getTopology() const {
+    return topology.get();
+}
+
+uint64_t Interconnect::getBusBusyCycles() const {
+    return busyCycles;
+}
+
+uint64_t Interconnect::getCompletedTransactions() const {
+    return completedTransactions;
+}
+
+size_t Interconnect::getPeakInFlight() const {
+    return peakInFlight;
+}
+
+const LatencyHistogram& Interconnect::getLatency(uint16_t pe) const {
+    return latencies[pe];
+}
+
+const InterconnectStats& Interconnect::getStats() const {
+    return stats;
+}
+
+void Interconnect::saveState(CheckpointWriter& out) const {
+    out.put(clockCycle);
+    out.put(nextServiceAt);
+    arbiter->saveState(out);
+
+    out.put<uint64_t>(inFlight);
+    out.put<uint64_t>(peakInFlight);
+    out.put(nextPendingSeq);
+    out.put(busyCycles);
+    out.put(completedTransactions);
+    out.put<uint64_t>(pendingResponses.size()); // Heaps en el orden del vector (siguen siendo válidos)
+    for (const PendingResponse& pending : pendingResponses) {
+        out.put(pending.ready);
+        out.put(pending.seq);
+        out.put(pending.issued);
+        out.put(pending.bytes);
+        out.put(uint8_t(pending.installs));
+        out.putMessage(pending.response);
+    }
+    out.put<uint64_t>(networkArrivals.size());
+    for (const NetworkArrival& arrival : networkArrivals) {
+        out.put(arrival.arrival);
+        out.put(arrival.seq);
+        out.putMessage(arrival.msg);
+    }
+    out.put(uint8_t(topology != nullptr));
+    if (topology) topology->saveState(out);
+
+    out.put<uint64_t>(latencies.size());
+    for (const LatencyHistogram& latency : latencies) latency.saveState(out);
+    out.putVector(scheduledDelivery);
+    sharerDirectory.saveState(out);
+    out.put(invalidationsSent);
+    out.put(invalidationsAvoided);
+
+    out.put(stats.received);
+    out.put(stats.sent);
+    stats.queueOccupancy.saveState(out);
+    out.put(stats.memoryReads);
+    out.put(stats.memoryWrites);
+    out.put(stats.cacheToCacheTransfers);
+    out.put(stats.writebacks);
+    out.put(stats.recalledLines);
+    out.put(stats.lineTransferBytes);
+
+    mainMemory.saveState(out);
+}
+
+void Interconnect::loadState(CheckpointReader& in) {
+    in.get(clockCycle);
+    in.get(nextServiceAt);
+    arbiter->loadState(in);
+
+    inFlight = size_t(in.get<uint64_t>());
+    peakInFlight = size_t(in.get<uint64_t>());
+    in.get(nextPendingSeq);
+    in.get(busyCycles);
+    in.get(completedTransactions);
+    pendingResponses.clear();
+    uint64_t responses = in.get<uint64_t>();
+    for (uint64_t i = 0; i < responses && in.ok(); ++i) {
+        PendingResponse pending;
+        in.get(pending.ready);
+        in.get(pending.seq);
+        in.get(pending.issued);
+        in.get(pending.bytes);
+        pending.installs = in.get<uint8_t>() != 0;
+        in.getMessage(pending.response);
+        pendingResponses.push_back(std::move(pending));
+    }
+    networkArrivals.clear();
+    uint64_t arrivals = in.get<uint64_t>();
+    for (uint64_t i = 0; i < arrivals && in.ok(); ++i) {
+        NetworkArrival arrival;
+        in.get(arrival.arrival);
+        in.get(arrival.seq);
+        in.getMessage(arrival.msg);
+        networkArrivals.push_back(std::move(arrival));
+    }
+    if ((in.get<uint8_t>() != 0) != (topology != nullptr)) in.fail();
+    if (topology && in.ok()) topology->loadState(in);
+
+    if (in.get<uint64_t>() != latencies.size()) in.fail();
+    for (LatencyHistogram& latency : latencies) {
+        if (!in.ok()) return;
+        latency.loadState(in);
+    }
+    size_t numPEs = scheduledDelivery.size();
+    in.getVector(scheduledDelivery);
+    if (scheduledDelivery.size() != numPEs) in.fail();
+    sharerDirectory.loadState(in);
+    in.get(invalidationsSent);
+    in.get(invalidationsAvoided);
+
+    in.get(stats.received);
+    in.get(stats.sent);
+    stats.queueOccupancy.loadState(in);
+    in.get(stats.memoryReads);
+    in.get(stats.memoryWrites);
+    in.get(stats.cacheToCacheTransfers);
+    in.get(stats.writebacks);
+    in.get(stats.recalledLines);
+    in.get(stats.lineTransferBytes);
+
+    if (in.ok()) mainMemory.loadState(in);
+}
+
+// Punto de entrada de los eventos del kernel de simulación
+void Interconnect::handleEvent(EventType type, uint64_t now) {
+    if (type == EventType::INTERCONNECT_SERVICE) service(now);
+}
+
+// Entrega una respuesta a un PE: queda en su bandeja y se agenda el evento de entrega en el ciclo de
+// llegada. Las respuestas al mismo PE en el mismo ciclo comparten un solo evento (el PE las vacía juntas).
+void Interconnect::deliver(PE* pe, Message& response, uint64_t arrival) {
+    response.cycle = arrival;
+    stats.sent.add(response);
+    pe->receiveResponse(std::move(response));
+
+    uint64_t& scheduled = scheduledDelivery[pe->getId()];
+    if (scheduled == arrival && arrival > simulator->now()) return; // Ya hay una entrega pendiente en ese ciclo
+    scheduled = arrival;
+    simulator->schedule(arrival, EventType::RESPONSE_DELIVERY, pe);
+}
+
+// Punto de entrada del bus: en cada ciclo en que queda libre concede una fase según el modo
+void Interconnect::service(uint64_t now) {
     {
-        std::lock_guard<std::mutex> lock(queueMutex); // Adquiere un lock del mutex para proteger el acceso a la cola de mensajes
-        if (executionMode == 1) { // Modo Prioridad
-            priorityMessageQueue.push(msg);
-        } else { // Modo FIFO (por defecto o si executionMode no es 1)
-            fifoMessageQueue.push_back(msg);
+        std::lock_guard<std::mutex> lock(queueMutex);
+        if (now >= nextServiceAt) nextServiceAt = NO_SERVICE; // Este es el servicio agendado (o uno posterior)
+    }
+
+    if (topology) serviceNetwork(now);
+    else if (busMode == BusMode::SPLIT) serviceSplit(now);
+    else serviceAtomic(now);
+
+    scheduleNextService();
+}
+
+// Modo atómico: arbitra y procesa un mensaje completo (transferencia, acceso a memoria y respuesta).
+// El bus queda tomado hasta que sale la respuesta.
+void Interconnect::serviceAtomic(uint64_t now) {
+    Message msg; // Variable para almacenar el mensaje a procesar
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        if (arbiter->empty()) return;
+        msg = arbiter->pop(); // La política de arbitraje elige entre los mensajes ya emitidos
+    }
+
+    clockCycle = std::max({clockCycle, now, msg.cycle});
+    uint64_t grant = clockCycle;
+
+    stepGate(clockCycle, msg.src, messageTypeName(msg.type)); // Espera según el modo de avance configurado
+
+    // Procesar el mensaje según su tipo
+    switch (msg.type) {
+        case MessageType::READ_MEM:
+        case MessageType::WRITE_MEM: {
+            PendingResponse pending = beginTransaction(msg);
+            busyCycles += clockCycle + 1 - grant; // La espera a la memoria no cuenta como transferencia
+            clockCycle = std::max(clockCycle + 1, pending.ready); // Generar la respuesta (esperando a la memoria)
+            finishTransaction(pending, clockCycle);
+            completedTransactions++;
+            break;
+        }
+        case MessageType::BROADCAST_INVALIDATE:
+            invalidate(msg);
+            busyCycles += clockCycle - grant;
+            break;
+        default: {
+            std::lock_guard<std::mutex> lock(consoleMutex());
+            std::cout << "IntConnect: Tipo de mensaje no implementado.\n";
         }
     }
-    cv.notify_one(); // Notifica a un thread que esté esperando en la variable de condición que hay un nuevo mensaje
 }
 
-// Método para registrar un PE en el Interconnect
-void Interconnect::registerPE(uint8_t id, PE* pe) {
-    peDirectory[id] = pe; // Asocia el ID del PE con un puntero al objeto PE en el directorio de PEs
+// Modo de transacciones divididas: la solicitud y la respuesta son fases separadas del bus.
+// Mientras la memoria atiende una transacción el bus transfiere otras, hasta maxInFlight a la vez.
+void Interconnect::serviceSplit(uint64_t now) {
+    if (now < clockCycle) return; // El bus sigue ocupado: se reagenda para cuando quede libre
+
+    // Las respuestas listas tienen prioridad: liberan lugares de transacciones en vuelo
+    if (!pendingResponses.empty() && pendingResponses.front().ready <= now) {
+        std::pop_heap(pendingResponses.begin(), pendingResponses.end(), ComparePending());
+        PendingResponse pending = std::move(pendingResponses.back());
+        pendingResponses.pop_back();
+
+        clockCycle = now;
+        uint64_t transfer = finishTransaction(pending, clockCycle);
+        clockCycle += transfer; // La respuesta ocupa el bus mientras se transfiere
+        busyCycles += transfer;
+        inFlight--;
+        completedTransactions++;
+        return;
+    }
+
+    if (inFlight >= maxInFlight) return; // Se espera a que salga alguna respuesta
+
+    Message msg;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        if (arbiter->empty()) return;
+        msg = arbiter->pop();
+    }
+
+    clockCycle = std::max(now, msg.cycle);
+    uint64_t grant = clockCycle;
+
+    stepGate(clockCycle, msg.src, messageTypeName(msg.type));
+
+    switch (msg.type) {
+        case MessageType::READ_MEM:
+        case MessageType::WRITE_MEM: {
+            // Solo la solicitud ocupa el bus; la respuesta espera en la cola hasta que la memoria termina
+            PendingResponse pending = beginTransaction(msg);
+            pending.seq = nextPendingSeq++;
+            pendingResponses.push_back(std::move(pending));
+            std::push_heap(pendingResponses.begin(), pendingResponses.end(), ComparePending());
+            inFlight++;
+            peakInFlight = std::max(peakInFlight, inFlight);
+            break;
+        }
+        case MessageType::BROADCAST_INVALIDATE:
+            invalidate(msg); // Las invalidaciones siguen siendo atómicas
+            break;
+        default: {
+            std::lock_guard<std::mutex> lock(consoleMutex());
+            std::cout << "IntConnect: Tipo de mensaje no implementado.\n";
+        }
+    }
+    busyCycles += clockCycle - grant;
 }
 
-// Bucle principal de procesamiento de mensajes del Interconnect (ejecutado en un thread separado)
-void Interconnect::processLoop() {
-    while (true) { // Bucle mientras el Interconnect esté en ejecución
-        Message msg; // Variable para almacenar el mensaje a procesar
-        int arriveTransferTime;
-        int sendTransferTime;
-
-        {
-            std::unique_lock<std::mutex> lock(queueMutex); // Adquiere un unique lock para la cola de mensajes
-            // Espera hasta que haya mensajes en la cola apropiada o el Interconnect se detenga
-            cv.wait(lock, [this]() {
-                return (executionMode == 1 && !priorityMessageQueue.empty()) ||
-                    (executionMode != 1 && !fifoMessageQueue.empty()) ||
-                        !running;
-            });
-
-            // Si el Interconnect no está en ejecución y ambas colas están vacías, sale del bucle
-            if (fifoMessageQueue.empty() && priorityMessageQueue.empty() && !running) break;
-
-            if (executionMode == 1) { // Modo Prioridad
-                msg = priorityMessageQueue.top();
-                priorityMessageQueue.pop();
-            } else { // Modo FIFO
-                msg = fifoMessageQueue.front();
-                fifoMessageQueue.erase(fifoMessageQueue.begin());
-            }
+// Red de enlaces: el controlador de memoria acepta una solicitud por ciclo y las respuestas salen en
+// cuanto la memoria las deja listas; la contención la resuelven los enlaces de la topología.
+// En modo atómico el controlador atiende una transacción a la vez; en split, hasta maxInFlight.
+void Interconnect::serviceNetwork(uint64_t now) {
+    topology->advance(now);
+    {
+        // Las solicitudes que ya llegaron al controlador pasan al árbitro en orden de llegada
+        std::lock_guard<std::mutex> lock(queueMutex);
+        while (!networkArrivals.empty() && networkArrivals.front().arrival <= now) {
+            std::pop_heap(networkArrivals.begin(), networkArrivals.end(), CompareArrival());
+            arbiter->push(std::move(networkArrivals.back().msg));
+            stats.queueOccupancy.record(arbiter->size());
+            networkArrivals.pop_back();
         }
+    }
+
+    while (!pendingResponses.empty() && pendingResponses.front().ready <= now) {
+        std::pop_heap(pendingResponses.begin(), pendingResponses.end(), ComparePending());
+        PendingResponse pending = std::move(pendingResponses.back());
+        pendingResponses.pop_back();
+
+        finishTransaction(pending, now);
+        inFlight--;
+        completedTransactions++;
+    }
+
+    if (now < clockCycle || inFlight >= transactionLimit()) return;
 
-        {
-            std::lock_guard<std::mutex> lock(cin_mutex);
-            std::cin.get(); // Espera a que el usuario presione Enter
+    Message msg;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        if (arbiter->empty()) return;
+        msg = arbiter->pop();
+    }
+
+    clockCycle = now;
+    stepGate(clockCycle, msg.src, messageTypeName(msg.type));
+
+    switch (msg.type) {
+        case MessageType::READ_MEM:
+        case MessageType::WRITE_MEM: {
+            PendingResponse pending = beginTransaction(msg);
+            pending.seq = nextPendingSeq++;
+            pendingResponses.push_back(std::move(pending));
+            std::push_heap(pendingResponses.begin(), pendingResponses.end(), ComparePending());
+            inFlight++;
+            peakInFlight = std::max(peakInFlight, inFlight);
+            break;
         }
+        case MessageType::BROADCAST_INVALIDATE:
+            invalidateNetwork(msg, now);
+            break;
+        default: {
+            std::lock_guard<std::mutex> lock(consoleMutex());
+            std::cout << "IntConnect: Tipo de mensaje no implementado.\n";
+        }
+    }
+    clockCycle = now + 1;
+}
 
-        int peClock = peDirectory[msg.src]->getCycleCounter();
-        clockCycle = std::max(clockCycle, peClock);
+// Transacciones que el controlador de la red puede tener en vuelo
+size_t Interconnect::transactionLimit() const {
+    return busMode == BusMode::SPLIT ? maxInFlight : 1;
+}
 
-        // Procesar el mensaje según su tipo
-        switch (msg.type) {
-            case MessageType::READ_MEM: {
+// Agenda el próximo servicio del bus si hay trabajo: mensajes por arbitrar o respuestas por enviar
+void Interconnect::scheduleNextService() {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    uint64_t next = NO_SERVICE;
+    if (topology) {
+        if (!networkArrivals.empty()) next = networkArrivals.front().arrival;
+        if (!pendingResponses.empty()) next = std::min(next, pendingResponses.front().ready);
+        if (!arbiter->empty() && inFlight < transactionLimit()) next = std::min(next, clockCycle);
+        requestService(next);
+        return;
+    }
+    if (busMode == BusMode::SPLIT && !pendingResponses.empty()) {
+        next = std::max(clockCycle, pendingResponses.front().ready);
+    }
+    if (!arbiter->empty() && (busMode == BusMode::ATOMIC || inFlight < maxInFlight)) {
+        next = std::min(next, clockCycle);
+    }
+    requestService(next);
+}
 
-                // -------------------- Procesar Mensaje --------------------
+// Agenda un servicio en el ciclo indicado salvo que ya haya uno igual o anterior (requiere queueMutex)
+void Interconnect::requestService(uint64_t time) {
+    if (time >= nextServiceAt) return;
+    nextServiceAt = time;
+    simulator->schedule(time, EventType::INTERCONNECT_SERVICE, this);
+}
 
-                arriveTransferTime = 6 / BytesForCicle;
-                if (arriveTransferTime == 0) arriveTransferTime = 1;
+// Fase de solicitud de READ_MEM / WRITE_MEM: transfiere el mensaje, accede a la memoria y arma
+// la respuesta. Devuelve la respuesta con el ciclo en que la memoria la deja lista.
+Interconnect::PendingResponse Interconnect::beginTransaction(const Message& msg) {
+    PendingResponse pending;
+    Message& response = pending.response;
+    response.dest = msg.src;
+    response.addr = msg.addr;
+    response.qos = msg.qos;
+    pending.issued = msg.cycle;
 
-                clockCycle += arriveTransferTime;
+    if (msg.type == MessageType::READ_MEM) {
 
-                {
-                    std::lock_guard<std::mutex> lock(cout_mutex);
-                    std::cout << "IntConnect: Procesado READ_MEM PE " << int(msg.src)
-                                  << " Dirección 0x" << std::hex << msg.addr
-                                  << " (" << std::dec << msg.size << " bytes)\n";
-                    writeOutput( "READ_MEM 0 " +
-                                std::to_string(6) + " P" + std::to_string(msg.src) + " " + std::to_string(clockCycle));
-                }
+        // -------------------- Procesar Mensaje --------------------
 
-                auto data = mainMemory.read(msg.addr, msg.size); // Obtener el bloque deseado de memoria
+        int arriveTransferTime = 6 / BytesForCicle;
+        if (arriveTransferTime == 0) arriveTransferTime = 1;
 
-                // -------------------- Generar Respuesta --------------------
+        if (!topology) clockCycle += arriveTransferTime; // En una red la solicitud ya llegó al controlador
 
-                clockCycle++;
+        if (consoleTrace()) {
+            std::lock_guard<std::mutex> lock(consoleMutex());
+            std::cout << "IntConnect: Procesado READ_MEM PE " << int(msg.src)
+                          << " Dirección 0x" << std::hex << msg.addr
+                          << " (" << std::dec << msg.size << " bytes)\n";
+        }
+        writeOutput(clockCycle, MessageType::READ_MEM, 0, 6, msg.addr, TracePeer::PE, msg.src);
 
-                {
-                    std::lock_guard<std::mutex> lock(cout_mutex);
-                    std::cout << "IntConnect: Enviado READ_RESP a PE " << int(msg.src)
-                                  << " Dirección 0x" << std::hex << msg.addr
-                                  << " (" << std::dec << msg.size << " bytes)\n";
-                    writeOutput( "READ_RESP 1 " +
-                                std::to_string(6 + data.size()) + " P" + std::to_string(msg.src) + " " + std::to_string(clockCycle));
-                }
+        response.type = MessageType::READ_RESP;
+        response.size = msg.size;
 
-                Message response;
-                response.type = MessageType::READ_RESP;
-                response.dest = msg.src;
-                response.addr = msg.addr;
-                response.data = data;
-                response.qos = msg.qos;
+        if (protocol != CoherenceProtocol::NONE) {
+            coherentRead(msg, pending);
+            return pending;
+        }
 
-                sendTransferTime = (6 + response.data.size()) / BytesForCicle;
-                if (sendTransferTime == 0) sendTransferTime = 1;
+        // Obtener el bloque deseado de memoria directamente en la carga útil de la respuesta
+        response.data.resize(msg.size);
+        if (!mainMemory.read(msg.addr, response.data.data(), response.data.size())) response.data.clear();
+        if (coherenceMode == CoherenceMode::DIRECTORY) sharerDirectory.addSharer(msg.addr, msg.src);
+        stats.memoryReads++;
 
-                while (peDirectory[msg.src]->getCycleCounter() < clockCycle + sendTransferTime && !peDirectory[msg.src]->getComplete()) {waitUntilReady();}
-                if (peDirectory[msg.src]->getComplete() == true) peDirectory[msg.src]->setCycleCounter(clockCycle + sendTransferTime);
-                peDirectory[msg.src]->receiveResponse(response);
-                peDirectory[msg.src]->handleResponses();
+        pending.bytes = uint32_t(6 + response.data.size());
+        pending.ready = mainMemory.access(msg.addr, msg.size, clockCycle) + 1; // +1: generar la respuesta
+    } else {
 
-                break;
-            }
-            case MessageType::WRITE_MEM: {
+        // -------------------- Procesar Mensaje --------------------
 
-                // -------------------- Procesar Mensaje --------------------
+        int transferCycles = 6 + msg.data.size() / BytesForCicle;
+        if (transferCycles == 0) transferCycles = 1;
 
-                int transferCycles = 6 + msg.data.size() / BytesForCicle;
-                if (transferCycles == 0) transferCycles = 1;
+        if (!topology) clockCycle += transferCycles;
 
-                clockCycle += transferCycles;
+        if (consoleTrace()) {
+            std::lock_guard<std::mutex> lock(consoleMutex());
+            std::cout << "IntConnect: Procesado WRITE_MEM PE " << int(msg.src)
+                          << " Dirección 0x" << std::hex << msg.addr
+                          << " (" << std::dec << msg.data.size() << " bytes)\n";
+        }
+        writeOutput(clockCycle, MessageType::WRITE_MEM, 0, 6 + msg.data.size(), msg.addr, TracePeer::PE, msg.src);
 
-                {
-                    std::lock_guard<std::mutex> lock(cout_mutex);
-                    std::cout << "IntConnect: Procesado WRITE_MEM PE " << int(msg.src)
-                                  << " Dirección 0x" << std::hex << msg.addr
-                                  << " (" << std::dec << msg.data.size() << " bytes)\n";
-                    writeOutput( "WRITE_MEM 0 " +
-                                std::to_string(6 + msg.data.size()) + " P" + std::to_string(msg.src) + " " + std::to_string(clockCycle));
-                }
+        response.type = MessageType::WRITE_RESP;
+        response.status = true;
 
-                mainMemory.write(msg.addr, msg.data); // Escribir la información en Memoria
+        if (protocol != CoherenceProtocol::NONE) {
+            coherentWrite(msg, pending);
+            return pending;
+        }
 
-                // -------------------- Generar Respuesta --------------------
+        mainMemory.write(msg.addr, msg.data.data(), msg.data.size()); // Escribir la información en Memoria
+        if (coherenceMode == CoherenceMode::DIRECTORY) sharerDirectory.addSharer(msg.addr, msg.src); // El PE ya tiene la línea en su caché
+        stats.memoryWrites++;
 
-                clockCycle++;
+        pending.bytes = 3;
+        pending.ready = mainMemory.access(msg.addr, msg.data.size(), clockCycle) + 1;
+    }
+    return pending;
+}
 
-                Message response;
-                response.type = MessageType::WRITE_RESP;
-                response.qos = msg.qos;
-                response.dest = msg.src;
-                response.status = true;
+// Fase de respuesta: la respuesta sale por el bus (o la red) en el ciclo start y llega al PE al terminar
+// la transferencia. Devuelve los ciclos de transferencia.
+uint64_t Interconnect::finishTransaction(PendingResponse& pending, uint64_t start) {
+    Message& response = pending.response;
 
-                {
-                    std::lock_guard<std::mutex> lock(cout_mutex);
-                    std::cout << "IntConnect: Enviado WRITE_RESP PE " << int(msg.src)
-                                  << " Dirección 0x" << std::hex << msg.addr
-                                  << " (Exito)\n";
-                    writeOutput( "WRITE_RESP 0 " +
-                                std::to_string(3) + " P" + std::to_string(msg.src) + " " + std::to_string(clockCycle));
-                }
+    // -------------------- Generar Respuesta --------------------
 
-                sendTransferTime = 3 / BytesForCicle;
-                if (sendTransferTime == 0) sendTransferTime = 1;
+    if (consoleTrace()) {
+        std::lock_guard<std::mutex> lock(consoleMutex());
+        if (response.type == MessageType::READ_RESP) {
+            std::cout << "IntConnect: Enviado READ_RESP a PE " << int(response.dest)
+                          << " Dirección 0x" << std::hex << response.addr
+                          << " (" << std::dec << response.size << " bytes)\n";
+        } else {
+            std::cout << "IntConnect: Enviado WRITE_RESP PE " << int(response.dest)
+                          << " Dirección 0x" << std::hex << response.addr
+                          << " (Exito)\n";
+        }
+    }
+    // WRITE_RESP conserva la dirección 0 del formato original
+    uint8_t direction = response.type == MessageType::READ_RESP ? 1 : 0;
+    writeOutput(start, response.type, direction, pending.bytes, response.addr, TracePeer::PE, response.dest);
+
+    int sendTransferTime = pending.bytes / BytesForCicle;
+    if (sendTransferTime == 0) sendTransferTime = 1;
+
+    uint64_t arrival = topology ? topology->transfer(memoryNode, response.dest, pending.bytes, start)
+                                : start + sendTransferTime;
+    if (pending.installs) peDirectory[response.dest]->setLineReady(response.addr, arrival);
+    if (simulator->measuring(pending.issued)) latencies[response.dest].record(arrival - pending.issued);
+    deliver(peDirectory[response.dest], response, arrival);
+    return arrival - start;
+}
 
-                while (peDirectory[msg.src]->getCycleCounter() < clockCycle + sendTransferTime && !peDirectory[msg.src]->getComplete()) {waitUntilReady();}
+// -------------------- Protocolo de coherencia (MESI / MOESI) --------------------
+// El controlador serializa las solicitudes de cada línea: al conceder una consulta las cachés con copia
+// (todas con broadcast, solo las del directorio en modo DIRECTORY), ajusta sus estados y deja instalada
+// la línea del solicitante, que recién se puede leer cuando le llega la respuesta.
 
-                peDirectory[msg.src]->receiveResponse(response);
-                peDirectory[msg.src]->handleResponses();
+// READ_MEM (GetS): una copia sucia la sirve la caché dueña sin pasar por memoria. Con MESI el dueño
+// además la escribe en memoria y queda en S; con MOESI queda en O y conserva la responsabilidad.
+// Si nadie más tiene la línea, el solicitante la recibe en E y podrá escribirla sin avisar.
+void Interconnect::coherentRead(const Message& msg, PendingResponse& pending) {
+    Message& response = pending.response;
+    uint32_t offset = msg.addr % lineSize;
+    uint32_t lineAddr = msg.addr - offset;
+    std::array<uint8_t, CacheBlock::MAX_LINE_SIZE> line{};
 
-                break;
+    if (CacheBlock* own = peDirectory[msg.src]->snoopLine(msg.addr)) {
+        // Ya se le concedió la línea y la respuesta sigue en camino: se le reenvía su propia copia
+        std::copy(own->data.begin(), own->data.begin() + lineSize, line.begin());
+        pending.ready = clockCycle + 1;
+    } else {
+        findHolders(msg.addr, msg.src);
+        int owner = -1;
+        for (uint16_t pe_id : invalidationTargets) {
+            CacheBlock* block = peDirectory[pe_id]->snoopLine(msg.addr);
+            if (isDirty(block->state)) owner = pe_id;
+            else if (block->state == CoherenceState::EXCLUSIVE) block->state = CoherenceState::SHARED;
+        }
+
+        if (owner >= 0) {
+            CacheBlock* block = peDirectory[owner]->snoopLine(msg.addr);
+            std::copy(block->data.begin(), block->data.begin() + lineSize, line.begin());
+            pending.ready = lineTransfer(uint16_t(owner), clockCycle) + 1;
+            stats.cacheToCacheTransfers++;
+            if (protocol == CoherenceProtocol::MOESI) {
+                block->state = CoherenceState::OWNED;
+            } else {
+                writeBack(lineAddr, line.data()); // La memoria toma la línea de la misma transferencia
+                block->state = CoherenceState::SHARED;
+            }
+            if (consoleTrace()) {
+                std::lock_guard<std::mutex> lock(consoleMutex());
+                std::cout << "IntConnect: Línea 0x" << std::hex << lineAddr << std::dec << " servida por la caché del PE "
+                          << owner << " al PE " << int(msg.src) << "\n";
+            }
+        } else {
+            if (!mainMemory.read(lineAddr, line.data(), lineSize)) {
+                response.data.clear();
+                pending.bytes = 6;
+                pending.ready = clockCycle + 1;
+                return;
             }
-            case MessageType::BROADCAST_INVALIDATE: {
+            stats.memoryReads++;
+            pending.ready = mainMemory.access(msg.addr, msg.size, clockCycle) + 1;
+        }
 
-                int transferCycles = 6 / BytesForCicle;
-                if (transferCycles == 0) transferCycles = 1;
+        installLine(msg.src, msg.addr,
+                    invalidationTargets.empty() ? CoherenceState::EXCLUSIVE : CoherenceState::SHARED, line.data());
+        pending.installs = true;
+    }
 
-                clockCycle += transferCycles;
+    response.data.assign(line.data() + offset, std::min<size_t>(msg.size, lineSize - offset));
+    pending.bytes = uint32_t(6 + response.data.size());
+}
 
-                uint8_t sourcePE = msg.src;
+// WRITE_MEM (GetM): invalida las demás copias (los INV_ACK salen juntos) y deja la línea en M en la
+// caché del solicitante con los bytes escritos. Los datos vienen de la caché dueña, de la memoria o,
+// si el solicitante ya tenía una copia (upgrade), no viajan. La memoria no se escribe.
+void Interconnect::coherentWrite(const Message& msg, PendingResponse& pending) {
+    Message& response = pending.response;
+    uint32_t offset = msg.addr % lineSize;
+    uint32_t lineAddr = msg.addr - offset;
+    std::array<uint8_t, CacheBlock::MAX_LINE_SIZE> line{};
 
-                {
-                    std::lock_guard<std::mutex> lock(cout_mutex);
-                    std::cout << "IntConnect: Procesado BROADCAST_INVALIDATE PE " << int(msg.src)
-                                  << " Dirección 0x" << std::hex << msg.addr << "\n";
-                    writeOutput( "BROADCAST_INVALIDATE 0 " +
-                                std::to_string(6) + " P" + std::to_string(sourcePE) + " " + std::to_string(clockCycle));
-                }
+    findHolders(msg.addr, msg.src);
+    CacheBlock* own = peDirectory[msg.src]->snoopLine(msg.addr);
+    uint64_t dataReady = clockCycle + 1;
+    if (own) {
+        std::copy(own->data.begin(), own->data.begin() + lineSize, line.begin());
+    } else {
+        int owner = -1;
+        for (uint16_t pe_id : invalidationTargets) {
+            if (isDirty(peDirectory[pe_id]->snoopLine(msg.addr)->state)) owner = pe_id;
+        }
+        if (owner >= 0) {
+            CacheBlock* block = peDirectory[owner]->snoopLine(msg.addr);
+            std::copy(block->data.begin(), block->data.begin() + lineSize, line.begin());
+            dataReady = lineTransfer(uint16_t(owner), clockCycle) + 1;
+            stats.cacheToCacheTransfers++;
+        } else {
+            mainMemory.read(lineAddr, line.data(), lineSize);
+            stats.memoryReads++;
+            dataReady = mainMemory.access(lineAddr, lineSize, clockCycle) + 1;
+        }
+    }
 
-                clockCycle++;
+    // Invalidaciones: en el bus salen en un mismo ciclo; en una red se espera el último ack
+    uint64_t acksDone = clockCycle;
+    if (!invalidationTargets.empty()) {
+        if (!topology) clockCycle++;
+        uint64_t sent = clockCycle;
+        int sendTransferTime = (2) / BytesForCicle;
+        if (sendTransferTime == 0) sendTransferTime = 1;
 
-                {
-                    std::lock_guard<std::mutex> lock(cout_mutex);
-                    std::cout << "IntConnect: Enviado INV_ACK a PE's Invalidación 0x" << std::hex << msg.addr << "\n";
-                    writeOutput( "INV_ACK 1 " +
-                                std::to_string(2) + " All " + std::to_string(clockCycle));
-                }
+        for (uint16_t pe_id : invalidationTargets) {
+            PE* pe_ptr = peDirectory[pe_id];
+            if (consoleTrace()) {
+                std::lock_guard<std::mutex> lock(consoleMutex());
+                std::cout << "IntConnect: Enviado INV_ACK a PE " << pe_id << " Invalidación 0x" << std::hex << msg.addr << "\n";
+            }
+            writeOutput(sent, MessageType::INV_ACK, 1, 2, msg.addr, TracePeer::PE, pe_id);
 
-                sendTransferTime = (2) / BytesForCicle;
-                if (sendTransferTime == 0) sendTransferTime = 1;
-
-                for (auto& [pe_id, pe_ptr] : peDirectory) {
-                    if (pe_id != sourcePE && pe_ptr) {
-                        pe_ptr->invalidateCacheLine(msg.addr);
-                        Message invAck;
-                        invAck.type = MessageType::INV_ACK;
-                        invAck.src = pe_id;
-                        invAck.qos = pe_ptr->getQoS();
-                        while (pe_ptr->getCycleCounter() < clockCycle + sendTransferTime && !peDirectory[msg.src]->getComplete()) {waitUntilReady();}
-                        pe_ptr->receiveResponse(invAck);
-                        pe_ptr->handleResponses();
-                    }
-                }
+            pe_ptr->invalidateCacheLine(msg.addr);
+            Message invAck;
+            invAck.type = MessageType::INV_ACK;
+            invAck.src = pe_id;
+            invAck.qos = pe_ptr->getQoS();
+            uint64_t arrival = topology ? topology->transfer(memoryNode, pe_id, 2, sent) : sent + sendTransferTime;
+            deliver(pe_ptr, invAck, arrival);
+            acksDone = std::max(acksDone, topology ? topology->transfer(pe_id, memoryNode, 2, arrival) : sent);
+        }
+        invalidationsSent += invalidationTargets.size();
+    }
+    if (coherenceMode == CoherenceMode::DIRECTORY) sharerDirectory.invalidateOthers(msg.addr, msg.src);
+
+    size_t count = std::min<size_t>(msg.data.size(), lineSize - offset);
+    std::copy(msg.data.begin(), msg.data.begin() + count, line.begin() + offset);
+    if (own) {
+        std::copy(line.begin(), line.begin() + lineSize, own->data.begin());
+        own->state = CoherenceState::MODIFIED;
+        pending.bytes = 3;
+    } else {
+        installLine(msg.src, msg.addr, CoherenceState::MODIFIED, line.data());
+        pending.installs = true;
+        response.data.assign(line.data(), lineSize); // La línea completa viaja con la respuesta
+        pending.bytes = uint32_t(3 + lineSize);
+    }
+    pending.ready = std::max(dataReady, acksDone + 1);
+}
+
+// Deja en invalidationTargets los PEs (distintos del solicitante) que tienen la línea en su caché
+void Interconnect::findHolders(uint32_t addr, uint16_t requester) {
+    std::vector<uint16_t>& holders = invalidationTargets;
+    if (coherenceMode == CoherenceMode::DIRECTORY) {
+        sharerDirectory.sharers(addr, holders, requester);
+    } else {
+        holders.clear();
+        for (uint16_t pe_id = 0; pe_id < peDirectory.size(); ++pe_id) {
+            if (pe_id != requester && peDirectory[pe_id]) holders.push_back(pe_id);
+        }
+    }
+    holders.erase(std::remove_if(holders.begin(), holders.end(),
+                                 [&](uint16_t pe_id) { return !peDirectory[pe_id]->snoopLine(addr); }),
+                  holders.end());
+}
+
+// Una línea completa viaja desde la caché de `from` (transferencia entre cachés o write-back).
+// En el bus lo ocupa; devuelve el ciclo en que llega el último byte.
+uint64_t Interconnect::lineTransfer(uint16_t from, uint64_t start) {
+    uint32_t bytes = 6 + lineSize;
+    stats.lineTransferBytes += bytes;
+    if (topology) return topology->transfer(from, memoryNode, bytes, start);
+
+    int transferCycles = bytes / BytesForCicle;
+    if (transferCycles == 0) transferCycles = 1;
+    clockCycle = std::max(clockCycle, start) + transferCycles;
+    return clockCycle;
+}
+
+// Instala la línea concedida en la caché del PE; si reemplaza una línea sucia, la escribe en memoria
+void Interconnect::installLine(uint16_t pe, uint32_t addr, CoherenceState state, const uint8_t* line) {
+    CacheBlock evicted;
+    CacheBlock& block = peDirectory[pe]->installLine(addr, state, evicted);
+    std::copy(line, line + lineSize, block.data.begin());
+    if (coherenceMode == CoherenceMode::DIRECTORY) sharerDirectory.addSharer(addr, pe);
+
+    if (!evicted.valid()) return;
+    uint32_t victimAddr = evicted.tag * lineSize;
+    if (coherenceMode == CoherenceMode::DIRECTORY) sharerDirectory.removeSharer(victimAddr, pe);
+    if (isDirty(evicted.state)) {
+        lineTransfer(pe, clockCycle);
+        writeBack(victimAddr, evicted.data.data());
+    }
+}
+
+void Interconnect::writeBack(uint32_t lineAddr, const uint8_t* line) {
+    mainMemory.write(lineAddr, line, lineSize);
+    mainMemory.access(lineAddr, lineSize, clockCycle);
+    stats.writebacks++;
+    stats.memoryWrites++;
+}
+
+// Write-back sin protocolo: si el PE tiene la línea sucia, sus bytes modificados viajan a memoria
+// junto con el ack antes de invalidarla
+void Interconnect::recallDirtyLine(uint16_t pe, uint32_t addr) {
+    CacheBlock* block = peDirectory[pe]->snoopLine(addr);
+    if (!block || !isDirty(block->state)) return;
+
+    uint32_t lineAddr = addr - addr % lineSize;
+    forEachByteRun(block->dirtyMask, [&](uint32_t offset, uint32_t count) {
+        mainMemory.write(lineAddr + offset, block->data.data() + offset, count);
+    });
+    mainMemory.access(lineAddr, lineSize, clockCycle);
+    lineTransfer(pe, clockCycle);
+    block->dirtyMask = 0;
+    stats.recalledLines++;
+    stats.memoryWrites++;
+}
+
+// BROADCAST_INVALIDATE: siempre atómico, ocupa el bus hasta enviar el INV_COMPLETE
+void Interconnect::invalidate(const Message& msg) {
+    int transferCycles = 6 / BytesForCicle;
+    if (transferCycles == 0) transferCycles = 1;
+
+    clockCycle += transferCycles;
+
+    uint16_t sourcePE = msg.src;
+
+    if (consoleTrace()) {
+        std::lock_guard<std::mutex> lock(consoleMutex());
+        std::cout << "IntConnect: Procesado BROADCAST_INVALIDATE PE " << int(msg.src)
+                      << " Dirección 0x" << std::hex << msg.addr << "\n";
+    }
+    writeOutput(clockCycle, MessageType::BROADCAST_INVALIDATE, 0, 6, msg.addr, TracePeer::PE, sourcePE);
+
+    int sendTransferTime = (2) / BytesForCicle;
+    if (sendTransferTime == 0) sendTransferTime = 1;
+
+    size_t broadcastTargets = 0; // Invalidaciones que enviaría un broadcast
+    for (PE* pe_ptr : peDirectory) {
+        if (pe_ptr && pe_ptr->getId() != sourcePE) broadcastTargets++;
+    }
+
+    if (coherenceMode == CoherenceMode::BROADCAST) {
+        clockCycle++;
+
+        if (consoleTrace()) {
+            std::lock_guard<std::mutex> lock(consoleMutex());
+            std::cout << "IntConnect: Enviado INV_ACK a PE's Invalidación 0x" << std::hex << msg.addr << "\n";
+        }
+        writeOutput(clockCycle, MessageType::INV_ACK, 1, 2, msg.addr, TracePeer::ALL);
 
-                clockCycle++;
+        for (uint16_t pe_id = 0; pe_id < peDirectory.size(); ++pe_id) {
+            PE* pe_ptr = peDirectory[pe_id];
+            if (pe_id != sourcePE && pe_ptr) {
+                recallDirtyLine(pe_id, msg.addr);
+                pe_ptr->invalidateCacheLine(msg.addr);
+                Message invAck;
+                invAck.type = MessageType::INV_ACK;
+                invAck.src = pe_id;
+                invAck.qos = pe_ptr->getQoS();
+                deliver(pe_ptr, invAck, clockCycle + sendTransferTime);
+            }
+        }
+        invalidationsSent += broadcastTargets;
+    } else {
+        // Directorio: solo se invalida a los PEs que tienen la línea; todas las
+        // invalidaciones salen en el mismo ciclo y los acks se recolectan en paralelo
+        std::vector<uint16_t>& targets = invalidationTargets; // Buffer reutilizado entre invalidaciones
+        sharerDirectory.sharers(msg.addr, targets, sourcePE);
 
-                Message invComplete;
-                invComplete.type = MessageType::INV_COMPLETE;
-                invComplete.dest = sourcePE;
-                invComplete.qos = peDirectory[sourcePE]->getQoS();
+        if (!targets.empty()) {
+            clockCycle++;
 
-                {
-                    std::lock_guard<std::mutex> lock(cout_mutex);
-                    std::cout << "IntConnect: Enviando INV_COMPLETE a PE " << int(sourcePE) << " por invalidación de línea 0x" << std::hex << msg.addr << "\n";
-                    writeOutput( "INV_ACK 1 " +
-                                std::to_string(2) + " P" + std::to_string(sourcePE) + " " + std::to_string(clockCycle));
+            for (uint16_t pe_id : targets) {
+                PE* pe_ptr = peDirectory[pe_id];
+                if (consoleTrace()) {
+                    std::lock_guard<std::mutex> lock(consoleMutex());
+                    std::cout << "IntConnect: Enviado INV_ACK a PE " << pe_id << " Invalidación 0x" << std::hex << msg.addr << "\n";
                 }
+                writeOutput(clockCycle, MessageType::INV_ACK, 1, 2, msg.addr, TracePeer::PE, pe_id);
+
+                recallDirtyLine(pe_id, msg.addr);
+                pe_ptr->invalidateCacheLine(msg.addr);
+                Message invAck;
+                invAck.type = MessageType::INV_ACK;
+                invAck.src = pe_id;
+                invAck.qos = pe_ptr->getQoS();
+                deliver(pe_ptr, invAck, clockCycle + sendTransferTime);
+            }
+        }
+        sharerDirectory.invalidateOthers(msg.addr, sourcePE);
+
+        invalidationsSent += targets.size();
+        invalidationsAvoided += broadcastTargets - targets.size();
+    }
+
+    clockCycle++;
+
+    Message invComplete;
+    invComplete.type = MessageType::INV_COMPLETE;
+    invComplete.dest = sourcePE;
+    invComplete.qos = peDirectory[sourcePE]->getQoS();
+
+    if (consoleTrace()) {
+        std::lock_guard<std::mutex> lock(consoleMutex());
+        std::cout << "IntConnect: Enviando INV_COMPLETE a PE " << int(sourcePE) << " por invalidación de línea 0x" << std::hex << msg.addr << "\n";
+    }
+    writeOutput(clockCycle, MessageType::INV_ACK, 1, 2, msg.addr, TracePeer::PE, sourcePE);
+
+    sendTransferTime = (2) / BytesForCicle;
+    if (sendTransferTime == 0) sendTransferTime = 1;
+
+    if (simulator->measuring(msg.cycle)) latencies[sourcePE].record(clockCycle + sendTransferTime - msg.cycle);
+    deliver(peDirectory[sourcePE], invComplete, clockCycle + sendTransferTime);
+}
+
+// BROADCAST_INVALIDATE en una red: las invalidaciones salen juntas del controlador y viajan por
+// rutas distintas; el INV_COMPLETE sale cuando vuelve el último ack
+void Interconnect::invalidateNetwork(const Message& msg, uint64_t now) {
+    uint16_t sourcePE = msg.src;
+
+    if (consoleTrace()) {
+        std::lock_guard<std::mutex> lock(consoleMutex());
+        std::cout << "IntConnect: Procesado BROADCAST_INVALIDATE PE " << int(msg.src)
+                      << " Dirección 0x" << std::hex << msg.addr << "\n";
+    }
+    writeOutput(now, MessageType::BROADCAST_INVALIDATE, 0, 6, msg.addr, TracePeer::PE, sourcePE);
+
+    std::vector<uint16_t>& targets = invalidationTargets;
+    size_t broadcastTargets = 0;
+    if (coherenceMode == CoherenceMode::BROADCAST) {
+        targets.clear();
+        for (uint16_t pe_id = 0; pe_id < peDirectory.size(); ++pe_id) {
+            if (pe_id != sourcePE && peDirectory[pe_id]) targets.push_back(pe_id);
+        }
+        broadcastTargets = targets.size();
+        writeOutput(now, MessageType::INV_ACK, 1, 2, msg.addr, TracePeer::ALL);
+    } else {
+        for (PE* pe_ptr : peDirectory) {
+            if (pe_ptr && pe_ptr->getId() != sourcePE) broadcastTargets++;
+        }
+        sharerDirectory.sharers(msg.addr, targets, sourcePE);
+    }
+
+    uint64_t acksDone = now + 1;
+    for (uint16_t pe_id : targets) {
+        PE* pe_ptr = peDirectory[pe_id];
+        if (consoleTrace()) {
+            std::lock_guard<std::mutex> lock(consoleMutex());
+            std::cout << "IntConnect: Enviado INV_ACK a PE " << pe_id << " Invalidación 0x" << std::hex << msg.addr << "\n";
+        }
+        if (coherenceMode == CoherenceMode::DIRECTORY) {
+            writeOutput(now, MessageType::INV_ACK, 1, 2, msg.addr, TracePeer::PE, pe_id);
+        }
+
+        recallDirtyLine(pe_id, msg.addr);
+        pe_ptr->invalidateCacheLine(msg.addr);
+        Message invAck;
+        invAck.type = MessageType::INV_ACK;
+        invAck.src = pe_id;
+        invAck.qos = pe_ptr->getQoS();
+        uint64_t arrival = topology->transfer(memoryNode, pe_id, 2, now);
+        deliver(pe_ptr, invAck, arrival);
+        acksDone = std::max(acksDone, topology->transfer(pe_id, memoryNode, 2, arrival)); // El ack vuelve al controlador
+    }
+
+    if (coherenceMode == CoherenceMode::DIRECTORY) sharerDirectory.invalidateOthers(msg.addr, sourcePE);
+    invalidationsSent += targets.size();
+    invalidationsAvoided += broadcastTargets - targets.size();
+
+    Message invComplete;
+    invComplete.type = MessageType::INV_COMPLETE;
+    invComplete.dest = sourcePE;
+    invComplete.qos = peDirectory[sourcePE]->getQoS();
+
+    if (consoleTrace()) {
+        std::lock_guard<std::mutex> lock(consoleMutex());
+        std::cout << "IntConnect: Enviando INV_COMPLETE a PE " << int(sourcePE) << " por invalidación de línea 0x" << std::hex << msg.addr << "\n";
+    }
+    writeOutput(acksDone, MessageType::INV_ACK, 1, 2, msg.addr, TracePeer::PE, sourcePE);
+    uint64_t arrival = topology->transfer(memoryNode, sourcePE, 2, acksDone);
+    if (simulator->measuring(msg.cycle)) latencies[sourcePE].record(arrival - msg.cycle);
+    deliver(peDirectory[sourcePE], invComplete, arrival);
+}
 
-                sendTransferTime = (2) / BytesForCicle;
-                if (sendTransferTime == 0) sendTransferTime = 1;
+void Interconnect::recordSharer(uint16_t pe, uint32_t addr) {
+    if (coherenceMode == CoherenceMode::DIRECTORY) sharerDirectory.addSharer(addr, pe);
+}
 
-                while (peDirectory[sourcePE]->getCycleCounter() < clockCycle + sendTransferTime && !peDirectory[msg.src]->getComplete()) {waitUntilReady();}
+// -------------------- Avance rápido (simulación muestreada) --------------------
+// Los mismos cambios de estado que el servicio detallado, aplicados en el acto: el sistema está
+// drenado (sin transacciones en vuelo) y el bus, los bancos y los enlaces no avanzan.
 
-                peDirectory[sourcePE]->receiveResponse(invComplete);
-                peDirectory[sourcePE]->handleResponses();
-                break;
+void Interconnect::functionalAccess(Message& msg) {
+    if (msg.type == MessageType::BROADCAST_INVALIDATE) {
+        // Los bytes sucios de las demás copias llegan a memoria antes de invalidarlas (write-back)
+        std::vector<uint16_t>& targets = invalidationTargets;
+        if (coherenceMode == CoherenceMode::DIRECTORY) {
+            sharerDirectory.sharers(msg.addr, targets, msg.src);
+            sharerDirectory.invalidateOthers(msg.addr, msg.src);
+        } else {
+            targets.clear();
+            for (uint16_t pe_id = 0; pe_id < peDirectory.size(); ++pe_id) {
+                if (pe_id != msg.src && peDirectory[pe_id]) targets.push_back(pe_id);
             }
-            default: {
-                std::lock_guard<std::mutex> lock(cout_mutex);
-                std::cout << "IntConnect: Tipo de mensaje no implementado.\n";
+        }
+        uint32_t lineAddr = msg.addr - msg.addr % lineSize;
+        for (uint16_t pe_id : targets) {
+            CacheBlock* block = peDirectory[pe_id]->snoopLine(msg.addr);
+            if (block && isDirty(block->state)) {
+                forEachByteRun(block->dirtyMask, [&](uint32_t offset, uint32_t count) {
+                    mainMemory.write(lineAddr + offset, block->data.data() + offset, count);
+                });
+                block->dirtyMask = 0;
             }
+            peDirectory[pe_id]->invalidateCacheLine(msg.addr);
         }
+        return;
     }
+
+    if (protocol != CoherenceProtocol::NONE) {
+        if (msg.type == MessageType::READ_MEM) functionalRead(msg);
+        else functionalWrite(msg);
+        return;
+    }
+
+    if (msg.type == MessageType::READ_MEM) {
+        msg.data.resize(msg.size);
+        if (!mainMemory.read(msg.addr, msg.data.data(), msg.data.size())) msg.data.clear();
+    } else {
+        mainMemory.write(msg.addr, msg.data.data(), msg.data.size());
+    }
+    if (coherenceMode == CoherenceMode::DIRECTORY) sharerDirectory.addSharer(msg.addr, msg.src);
 }
 
-void Interconnect::writeOutput(const std::string& line) {
-    std::ofstream file(outputPath, std::ios::app); // Abre el archivo en modo append
-    if (file.is_open()) {
-        file << line << '\n'; // Escribe la línea con salto de línea
+// GetS: como coherentRead, con la línea legible de inmediato
+void Interconnect::functionalRead(const Message& msg) {
+    uint32_t lineAddr = msg.addr - msg.addr % lineSize;
+    std::array<uint8_t, CacheBlock::MAX_LINE_SIZE> line{};
+    if (peDirectory[msg.src]->snoopLine(msg.addr)) return;
+
+    findHolders(msg.addr, msg.src);
+    int owner = -1;
+    for (uint16_t pe_id : invalidationTargets) {
+        CacheBlock* block = peDirectory[pe_id]->snoopLine(msg.addr);
+        if (isDirty(block->state)) owner = pe_id;
+        else if (block->state == CoherenceState::EXCLUSIVE) block->state = CoherenceState::SHARED;
     }
+
+    if (owner >= 0) {
+        CacheBlock* block = peDirectory[owner]->snoopLine(msg.addr);
+        std::copy(block->data.begin(), block->data.begin() + lineSize, line.begin());
+        if (protocol == CoherenceProtocol::MOESI) {
+            block->state = CoherenceState::OWNED;
+        } else {
+            mainMemory.write(lineAddr, line.data(), lineSize);
+            block->state = CoherenceState::SHARED;
+        }
+    } else if (!mainMemory.read(lineAddr, line.data(), lineSize)) {
+        return;
+    }
+    functionalInstall(msg.src, msg.addr,
+                      invalidationTargets.empty() ? CoherenceState::EXCLUSIVE : CoherenceState::SHARED, line.data());
+}
+
+// GetM: como coherentWrite, sin acks
+void Interconnect::functionalWrite(const Message& msg) {
+    uint32_t offset = msg.addr % lineSize;
+    uint32_t lineAddr = msg.addr - offset;
+    std::array<uint8_t, CacheBlock::MAX_LINE_SIZE> line{};
+
+    findHolders(msg.addr, msg.src);
+    CacheBlock* own = peDirectory[msg.src]->snoopLine(msg.addr);
+    if (own) {
+        std::copy(own->data.begin(), own->data.begin() + lineSize, line.begin());
+    } else {
+        int owner = -1;
+        for (uint16_t pe_id : invalidationTargets) {
+            if (isDirty(peDirectory[pe_id]->snoopLine(msg.addr)->state)) owner = pe_id;
+        }
+        if (owner >= 0) {
+            CacheBlock* block = peDirectory[owner]->snoopLine(msg.addr);
+            std::copy(block->data.begin(), block->data.begin() + lineSize, line.begin());
+        } else {
+            mainMemory.read(lineAddr, line.data(), lineSize);
+        }
+    }
+    for (uint16_t pe_id : invalidationTargets) peDirectory[pe_id]->invalidateCacheLine(msg.addr);
+    if (coherenceMode == CoherenceMode::DIRECTORY) sharerDirectory.invalidateOthers(msg.addr, msg.src);
+
+    size_t count = std::min<size_t>(msg.data.size(), lineSize - offset);
+    std::copy(msg.data.begin(), msg.data.begin() + count, line.begin() + offset);
+    if (own) {
+        std::copy(line.begin(), line.begin() + lineSize, own->data.begin());
+        own->state = CoherenceState::MODIFIED;
+    } else {
+        functionalInstall(msg.src, msg.addr, CoherenceState::MODIFIED, line.data());
+    }
+}
+
+// Como installLine, pero la víctima sucia se escribe en memoria sin ocupar el bus ni los bancos
+void Interconnect::functionalInstall(uint16_t pe, uint32_t addr, CoherenceState state, const uint8_t* line) {
+    CacheBlock evicted;
+    CacheBlock& block = peDirectory[pe]->installLine(addr, state, evicted);
+    std::copy(line, line + lineSize, block.data.begin());
+    block.readyCycle = 0;
+    if (coherenceMode == CoherenceMode::DIRECTORY) sharerDirectory.addSharer(addr, pe);
+
+    if (!evicted.valid()) return;
+    uint32_t victimAddr = evicted.tag * lineSize;
+    if (coherenceMode == CoherenceMode::DIRECTORY) sharerDirectory.removeSharer(victimAddr, pe);
+    if (isDirty(evicted.state)) mainMemory.write(victimAddr, evicted.data.data(), lineSize);
+}
+
+// Registra una línea en intconnect.txt (la escribe el hilo de trazas)
+void Interconnect::writeOutput(uint64_t cycle, MessageType type, uint8_t direction, size_t size, uint32_t addr, TracePeer peer, uint16_t peerId) {
+    TraceWriter* trace = simulator->getTraceWriter();
+    if (!trace) return;
+    TraceRecord rec;
+    rec.cycle = cycle;
+    rec.addr = addr;
+    rec.size = uint16_t(size);
+    rec.peer = peerId;
+    rec.op = traceOp(type);
+    rec.direction = direction;
+    rec.peerKind = peer;
+    trace->record(TraceWriter::INTERCONNECT_STREAM, rec);
 }
 
-int Interconnect::getclockCycle() const {
+uint64_t Interconnect::getclockCycle() const {
     return clockCycle;
 }
@@ -0,0 +1,79 @@
+#include "LatencyHistogram.hpp"
+#include <algorithm>
+#include <cmath>
+#include "Checkpoint.hpp"
+
+size_t LatencyHistogram::bucketOf(uint64_t cycles) {
+    if (cycles < (uint64_t(1) << EXACT_BITS)) return size_t(cycles);
+    unsigned exponent = 63 - unsigned(__builtin_clzll(cycles)); // >= EXACT_BITS
+    uint64_t sub = (cycles >> (exponent - SUB_BITS)) & ((uint64_t(1) << SUB_BITS) - 1);
+    return (size_t(1) << EXACT_BITS) + size_t(exponent - EXACT_BITS) * (size_t(1) << SUB_BITS) + size_t(sub);
+}
+
+uint64_t LatencyHistogram::bucketUpper(size_t bucket) {
+    if (bucket < (size_t(1) << EXACT_BITS)) return bucket;
+    size_t index = bucket - (size_t(1) << EXACT_BITS);
+    unsigned exponent = unsigned(index >> SUB_BITS) + EXACT_BITS;
+    uint64_t sub = index & ((size_t(1) << SUB_BITS) - 1);
+    return (((uint64_t(1) << SUB_BITS) + sub + 1) << (exponent - SUB_BITS)) - 1;
+}
+
+void LatencyHistogram::record(uint64_t cycles) {
+    size_t bucket = bucketOf(cycles);
+    if (bucket >= buckets.size()) buckets.resize(bucket + 1, 0);
+    buckets[bucket]++;
+    samples++;
+    total += cycles;
+    maxCycles = std::max(maxCycles, cycles);
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    if (other.buckets.size() > buckets.size()) buckets.resize(other.buckets.size(), 0);
+    for (size_t i = 0; i < other.buckets.size(); ++i) buckets[i] += other.buckets[i];
+    samples += other.samples;
+    total += other.total;
+    maxCycles = std::max(maxCycles, other.maxCycles);
+}
+
+uint64_t LatencyHistogram::percentile(double p) const {
+    if (samples == 0) return 0;
+    // Rango de la muestra buscada (método nearest-rank)
+    uint64_t rank = uint64_t(std::ceil(p / 100.0 * double(samples)));
+    rank = std::clamp<uint64_t>(rank, 1, samples);
+    uint64_t seen = 0;
+    for (size_t i = 0; i < buckets.size(); ++i) {
+        seen += buckets[i];
+        if (seen >= rank) return std::min(bucketUpper(i), maxCycles);
+    }
+    return maxCycles;
+}
+
+uint64_t LatencyHistogram::count() const {
+    return samples;
+}
+
+uint64_t LatencyHistogram::max() const {
+    return maxCycles;
+}
+
+double LatencyHistogram::mean() const {
+    return samples ? double(total) / double(samples) : 0.0;
+}
+
+uint64_t LatencyHistogram::sum() const {
+    return total;
+}
+
+void LatencyHistogram::saveState(CheckpointWriter& out) const {
+    out.putVector(buckets);
+    out.put(samples);
+    out.put(total);
+    out.put(maxCycles);
+}
+
+void LatencyHistogram::loadState(CheckpointReader& in) {
+    in.getVector(buckets);
+    in.get(samples);
+    in.get(total);
+    in.get(maxCycles);
+}
@@ -0,0 +1,122 @@
+#include "MSHR.hpp"
+#include <algorithm>
+#include "Checkpoint.hpp"
+
+void MSHRFile::setCapacity(size_t count) {
+    entries.assign(count, Entry{});
+    active = 0;
+}
+
+bool MSHRFile::enabled() const {
+    return !entries.empty();
+}
+
+void MSHRFile::advance(uint64_t now) {
+    if (now > lastChange && active > 0) {
+        outstandingCycles += active * (now - lastChange);
+        busyCycles += now - lastChange;
+    }
+    lastChange = std::max(lastChange, now);
+}
+
+MSHRFile::Result MSHRFile::allocate(uint32_t line, uint64_t now) {
+    Entry* free = nullptr;
+    for (Entry& entry : entries) {
+        if (entry.valid && entry.line == line) {
+            entry.targets++;
+            secondaryMisses++;
+            return Result::SECONDARY;
+        }
+        if (!entry.valid && !free) free = &entry;
+    }
+    if (!free) {
+        fullEvents++;
+        return Result::FULL;
+    }
+
+    advance(now);
+    *free = Entry{line, 1, true};
+    active++;
+    peakOutstanding = std::max(peakOutstanding, active);
+    primaryMisses++;
+    return Result::PRIMARY;
+}
+
+bool MSHRFile::release(uint32_t line, uint64_t now) {
+    for (Entry& entry : entries) {
+        if (entry.valid && entry.line == line) {
+            advance(now);
+            entry.valid = false;
+            active--;
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t MSHRFile::outstanding() const {
+    return active;
+}
+
+uint64_t MSHRFile::getPrimaryMisses() const {
+    return primaryMisses;
+}
+
+uint64_t MSHRFile::getSecondaryMisses() const {
+    return secondaryMisses;
+}
+
+uint64_t MSHRFile::getFullEvents() const {
+    return fullEvents;
+}
+
+size_t MSHRFile::getPeakOutstanding() const {
+    return peakOutstanding;
+}
+
+double MSHRFile::getMemoryLevelParallelism() const {
+    return busyCycles ? double(outstandingCycles) / double(busyCycles) : 0.0;
+}
+
+uint64_t MSHRFile::getOutstandingCycles() const {
+    return outstandingCycles;
+}
+
+uint64_t MSHRFile::getMissCycles() const {
+    return busyCycles;
+}
+
+void MSHRFile::saveState(CheckpointWriter& out) const {
+    out.put<uint64_t>(entries.size());
+    for (const Entry& entry : entries) {
+        out.put(entry.line);
+        out.put(entry.targets);
+        out.put(uint8_t(entry.valid));
+    }
+    out.put<uint64_t>(active);
+    out.put(primaryMisses);
+    out.put(secondaryMisses);
+    out.put(fullEvents);
+    out.put<uint64_t>(peakOutstanding);
+    out.put(lastChange);
+    out.put(outstandingCycles);
+    out.put(busyCycles);
+}
+
+void MSHRFile::loadState(CheckpointReader& in) {
+    if (in.get<uint64_t>() != entries.size()) in.fail();
+    if (!in.ok()) return;
+    for (Entry& entry : entries) {
+        in.get(entry.line);
+        in.get(entry.targets);
+        entry.valid = in.get<uint8_t>() != 0;
+    }
+    active = size_t(in.get<uint64_t>());
+    in.get(primaryMisses);
+    in.get(secondaryMisses);
+    in.get(fullEvents);
+    peakOutstanding = size_t(in.get<uint64_t>());
+    in.get(lastChange);
+    in.get(outstandingCycles);
+    in.get(busyCycles);
+}
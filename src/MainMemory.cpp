@@ -1,31 +1,374 @@
 #include "MainMemory.hpp"
 #include <algorithm>
+#include <cctype>
+#include <cstring>
 #include <iostream>
+#include <vector>
+#include "Checkpoint.hpp"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
 
-MainMemory::MainMemory() {
-    memory.resize(MEMORY_SIZE, 0);
+static bool isPowerOfTwo(uint64_t value) {
+    return value != 0 && (value & (value - 1)) == 0;
 }
 
-std::vector<uint8_t> MainMemory::read(uint32_t addr, size_t size) {
-    std::lock_guard<std::mutex> lock(memMutex);
+std::string memoryConfigError(const MemoryConfig& config) {
+    if (config.sizeBytes == 0 || config.sizeBytes > MainMemory::MAX_SIZE) {
+        return "El tamaño de la memoria debe estar entre 1 byte y 4G (direcciones de 32 bits).";
+    }
+    if (!isPowerOfTwo(config.banks) || config.banks > MainMemory::MAX_BANKS) {
+        return "La cantidad de bancos debe ser potencia de 2 entre 1 y " + std::to_string(MainMemory::MAX_BANKS) + ".";
+    }
+    if (!isPowerOfTwo(config.interleaveBytes) || config.interleaveBytes > MainMemory::PAGE_SIZE) {
+        return "El entrelazado de bancos debe ser potencia de 2 y a lo sumo " + std::to_string(MainMemory::PAGE_SIZE) + " bytes.";
+    }
+    return "";
+}
+
+bool parseByteSize(const std::string& text, uint64_t& bytes) {
+    if (text.empty() || !std::isdigit(static_cast<unsigned char>(text[0]))) return false;
+    size_t used = 0;
+    uint64_t value = std::stoull(text, &used);
+    std::string suffix = text.substr(used);
+    int shift = 0;
+    if (suffix == "K" || suffix == "k") shift = 10;
+    else if (suffix == "M" || suffix == "m") shift = 20;
+    else if (suffix == "G" || suffix == "g") shift = 30;
+    else if (!suffix.empty()) return false;
+    if (value > (UINT64_MAX >> shift)) return false;
+    bytes = value << shift;
+    return true;
+}
+
+MainMemory::MainMemory(uint64_t sizeBytes)
+    : memorySize(sizeBytes),
+      banks(std::make_unique<Bank[]>(1)) {}
+
+MainMemory::~MainMemory() {
+    unmap();
+    releasePages();
+}
+
+bool MainMemory::configure(const MemoryConfig& config) {
+    if (!mapBackingFile(config)) return false;
+    if (config.imageFile.empty()) return true;
+    return loadImage(config.imageFile);
+}
+
+bool MainMemory::mapBackingFile(const MemoryConfig& config) {
+    std::lock_guard<std::mutex> lock(configMutex);
+    unmap();
+    releasePages();
+    memorySize = config.sizeBytes;
+
+    numBanks = config.banks;
+    banks = std::make_unique<Bank[]>(numBanks);
+    interleaveShift = uint32_t(__builtin_ctzll(config.interleaveBytes));
+    bankLatency = config.bankLatency;
+    bankOccupancy = config.bankOccupancy;
+
+    if (!config.backingFile.empty()) {
+        int fd = ::open(config.backingFile.c_str(), O_RDWR | O_CREAT, 0644);
+        if (fd < 0) {
+            std::cerr << "ERROR: No se pudo abrir el archivo de memoria " << config.backingFile << "\n";
+            return false;
+        }
+        // Si el archivo es más chico se extiende sin escribir datos (queda disperso en disco)
+        off_t current = lseek(fd, 0, SEEK_END);
+        if (current < off_t(memorySize) && ftruncate(fd, off_t(memorySize)) != 0) {
+            ::close(fd);
+            std::cerr << "ERROR: No se pudo extender el archivo de memoria " << config.backingFile << "\n";
+            return false;
+        }
+        void* data = mmap(nullptr, memorySize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd); // El mapeo sigue siendo válido sin el descriptor
+        if (data == MAP_FAILED) {
+            std::cerr << "ERROR: No se pudo mapear el archivo de memoria " << config.backingFile << "\n";
+            return false;
+        }
+        madvise(data, memorySize, MADV_RANDOM); // Los accesos del simulador no son secuenciales
+        mapped = static_cast<uint8_t*>(data);
+    }
+    return true;
+}
+
+bool MainMemory::inRange(uint32_t addr, size_t size) const {
+    return uint64_t(addr) + size <= memorySize;
+}
 
-    if (addr + size > memory.size()) {
+const MainMemory::Page* MainMemory::findPage(uint64_t pageNumber) const {
+    const Leaf* leaf = root[pageNumber >> LEAF_BITS].load(std::memory_order_acquire);
+    if (!leaf) return nullptr;
+    return (*leaf)[pageNumber & (LEAF_ENTRIES - 1)].load(std::memory_order_acquire);
+}
+
+// Dos bancos pueden tocar por primera vez la misma hoja o página a la vez: gana el primero
+// que la instala y el otro descarta la suya
+MainMemory::Page& MainMemory::touchPage(uint64_t pageNumber) {
+    std::atomic<Leaf*>& leafSlot = root[pageNumber >> LEAF_BITS];
+    Leaf* leaf = leafSlot.load(std::memory_order_acquire);
+    if (!leaf) {
+        Leaf* fresh = new Leaf{};
+        if (leafSlot.compare_exchange_strong(leaf, fresh, std::memory_order_acq_rel)) leaf = fresh;
+        else delete fresh;
+    }
+
+    std::atomic<Page*>& pageSlot = (*leaf)[pageNumber & (LEAF_ENTRIES - 1)];
+    Page* page = pageSlot.load(std::memory_order_acquire);
+    if (!page) {
+        Page* fresh = new Page{}; // Inicializada en ceros
+        if (pageSlot.compare_exchange_strong(page, fresh, std::memory_order_acq_rel)) {
+            page = fresh;
+            pages.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            delete fresh;
+        }
+    }
+    return *page;
+}
+
+void MainMemory::releasePages() {
+    for (auto& leafSlot : root) {
+        Leaf* leaf = leafSlot.exchange(nullptr);
+        if (!leaf) continue;
+        for (auto& pageSlot : *leaf) delete pageSlot.load();
+        delete leaf;
+    }
+    pages = 0;
+}
+
+template <typename Fn>
+void MainMemory::forEachChunk(uint64_t addr, size_t size, Fn&& fn) {
+    uint64_t interleave = uint64_t(1) << interleaveShift; // Nunca mayor que una página
+    while (size > 0) {
+        size_t chunk = std::min<uint64_t>(size, interleave - (addr & (interleave - 1)));
+        Bank& bank = banks[(addr >> interleaveShift) & (numBanks - 1)];
+        {
+            std::lock_guard<std::mutex> lock(bank.mutex);
+            fn(addr, chunk);
+        }
+        addr += chunk;
+        size -= chunk;
+    }
+}
+
+bool MainMemory::read(uint32_t addr, uint8_t* out, size_t size) {
+    if (!inRange(addr, size)) {
         std::cerr << "ERROR: Lectura fuera de rango de memoria (addr = 0x"
                   << std::hex << addr << ", size = " << std::dec << size << ")\n";
-        return {};
+        return false;
     }
 
-    return std::vector<uint8_t>(memory.begin() + addr, memory.begin() + addr + size);
+    // Copia tramo por tramo; una página nunca escrita se lee como ceros
+    forEachChunk(addr, size, [&](uint64_t pos, size_t chunk) {
+        if (mapped) {
+            std::memcpy(out, mapped + pos, chunk);
+        } else if (const Page* page = findPage(pos >> PAGE_BITS)) {
+            std::memcpy(out, page->data() + (pos & (PAGE_SIZE - 1)), chunk);
+        } else {
+            std::memset(out, 0, chunk);
+        }
+        out += chunk;
+    });
+    return true;
 }
 
-void MainMemory::write(uint32_t addr, const std::vector<uint8_t>& data) {
-    std::lock_guard<std::mutex> lock(memMutex);
-
-    if (addr + data.size() > memory.size()) {
+bool MainMemory::write(uint32_t addr, const uint8_t* data, size_t size) {
+    if (!inRange(addr, size)) {
         std::cerr << "ERROR: Escritura fuera de rango de memoria (addr = 0x"
-                  << std::hex << addr << ", size = " << std::dec << data.size() << ")\n";
-        return;
+                  << std::hex << addr << ", size = " << std::dec << size << ")\n";
+        return false;
+    }
+
+    forEachChunk(addr, size, [&](uint64_t pos, size_t chunk) {
+        uint8_t* dest = mapped ? mapped + pos : touchPage(pos >> PAGE_BITS).data() + (pos & (PAGE_SIZE - 1));
+        std::memcpy(dest, data, chunk);
+        data += chunk;
+    });
+    return true;
+}
+
+uint64_t MainMemory::access(uint32_t addr, size_t size, uint64_t now) {
+    uint64_t done = now;
+    if (size == 0) size = 1; // Un acceso sin datos igual ocupa el banco de su dirección
+    std::bitset<MAX_BANKS> visited; // Bancos ya reservados por este acceso
+    forEachChunk(addr, size, [&](uint64_t pos, size_t) {
+        size_t index = size_t(pos >> interleaveShift) & (numBanks - 1);
+        if (visited.test(index)) return; // Un acceso ocupa cada banco una sola vez, aunque lo recorra de nuevo
+        visited.set(index);
+        Bank& bank = banks[index];
+        uint64_t start = std::max(now, bank.busyUntil);
+        bank.conflictCycles += start - now;
+        bank.busyUntil = start + bankOccupancy;
+        bank.accesses++;
+        done = std::max(done, start + bankLatency);
+    });
+    return done;
+}
+
+bool MainMemory::loadImage(const std::string& path) {
+    std::lock_guard<std::mutex> lock(configMutex);
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "ERROR: No se pudo abrir la imagen de memoria " << path << "\n";
+        return false;
+    }
+    uint64_t imageSize = uint64_t(lseek(fd, 0, SEEK_END));
+    if (imageSize > memorySize) {
+        ::close(fd);
+        std::cerr << "ERROR: La imagen " << path << " (" << imageSize << " bytes) no cabe en la memoria ("
+                  << memorySize << " bytes)\n";
+        return false;
+    }
+
+    // Se copia por páginas saltando los huecos del archivo (SEEK_DATA) y las páginas que son
+    // solo ceros, así la memoria sigue dispersa y cargar una instantánea cuesta según sus datos
+    Page buffer;
+    static const Page zeros = {};
+    bool ok = true;
+    uint64_t pos = 0;
+    while (ok && pos < imageSize) {
+        off_t data = lseek(fd, off_t(pos), SEEK_DATA);
+        if (data < 0) break; // No quedan datos hasta el final del archivo
+        pos = uint64_t(data) & ~(PAGE_SIZE - 1);
+        size_t chunk = std::min<uint64_t>(PAGE_SIZE, imageSize - pos);
+        ok = pread(fd, buffer.data(), chunk, off_t(pos)) == ssize_t(chunk);
+        if (ok && std::memcmp(buffer.data(), zeros.data(), chunk) != 0) write(uint32_t(pos), buffer.data(), chunk);
+        pos += chunk;
+    }
+    ::close(fd);
+
+    if (!ok) std::cerr << "ERROR: No se pudo leer la imagen de memoria " << path << "\n";
+    return ok;
+}
+
+bool MainMemory::saveSnapshot(const std::string& path) {
+    // Con todos los bancos tomados (en orden) la instantánea es consistente
+    std::lock_guard<std::mutex> lock(configMutex);
+    std::vector<std::unique_lock<std::mutex>> bankLocks;
+    for (size_t i = 0; i < numBanks; ++i) bankLocks.emplace_back(banks[i].mutex);
+
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        std::cerr << "ERROR: No se pudo crear la instantánea de memoria " << path << "\n";
+        return false;
+    }
+
+    // El archivo mide lo mismo que la memoria; las páginas sin datos quedan como huecos
+    bool ok = ftruncate(fd, off_t(memorySize)) == 0;
+    static const Page zeros = {};
+    uint64_t numPages = (memorySize + PAGE_SIZE - 1) / PAGE_SIZE;
+    for (uint64_t n = 0; ok && n < numPages; ++n) {
+        uint64_t pos = n * PAGE_SIZE;
+        size_t chunk = std::min<uint64_t>(PAGE_SIZE, memorySize - pos);
+        const uint8_t* data;
+        if (mapped) {
+            data = mapped + pos;
+            if (std::memcmp(data, zeros.data(), chunk) == 0) continue;
+        } else {
+            // Sin respaldo solo se recorren las hojas reservadas
+            if (!root[n >> LEAF_BITS].load(std::memory_order_acquire)) {
+                n |= LEAF_ENTRIES - 1;
+                continue;
+            }
+            const Page* page = findPage(n);
+            if (!page) continue;
+            data = page->data();
+        }
+        ok = pwrite(fd, data, chunk, off_t(pos)) == ssize_t(chunk);
+    }
+    ::close(fd);
+
+    if (!ok) std::cerr << "ERROR: No se pudo escribir la instantánea de memoria " << path << "\n";
+    return ok;
+}
+
+void MainMemory::saveState(CheckpointWriter& out) const {
+    std::lock_guard<std::mutex> lock(configMutex);
+    out.put<uint64_t>(numBanks);
+    for (size_t i = 0; i < numBanks; ++i) {
+        out.put(banks[i].busyUntil);
+        out.put(banks[i].accesses);
+        out.put(banks[i].conflictCycles);
+    }
+
+    // Páginas como (número, bytes), terminadas por UINT32_MAX; se recorren igual que en saveSnapshot
+    static const Page zeros = {};
+    uint64_t numPages = (memorySize + PAGE_SIZE - 1) / PAGE_SIZE;
+    for (uint64_t n = 0; n < numPages; ++n) {
+        size_t chunk = std::min<uint64_t>(PAGE_SIZE, memorySize - n * PAGE_SIZE);
+        const uint8_t* data;
+        if (mapped) {
+            data = mapped + n * PAGE_SIZE;
+        } else {
+            if (!root[n >> LEAF_BITS].load(std::memory_order_acquire)) {
+                n |= LEAF_ENTRIES - 1;
+                continue;
+            }
+            const Page* page = findPage(n);
+            if (!page) continue;
+            data = page->data();
+        }
+        if (std::memcmp(data, zeros.data(), chunk) == 0) continue;
+        out.put(uint32_t(n));
+        out.putBytes(data, chunk);
     }
+    out.put(UINT32_MAX);
+}
+
+void MainMemory::loadState(CheckpointReader& in) {
+    if (in.get<uint64_t>() != numBanks) in.fail();
+    if (!in.ok()) return;
+    for (size_t i = 0; i < numBanks; ++i) {
+        in.get(banks[i].busyUntil);
+        in.get(banks[i].accesses);
+        in.get(banks[i].conflictCycles);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(configMutex);
+        if (mapped) std::memset(mapped, 0, memorySize);
+        else releasePages();
+    }
+    uint64_t numPages = (memorySize + PAGE_SIZE - 1) / PAGE_SIZE;
+    Page buffer;
+    for (uint32_t n = in.get<uint32_t>(); n != UINT32_MAX && in.ok(); n = in.get<uint32_t>()) {
+        if (n >= numPages) {
+            in.fail();
+            return;
+        }
+        size_t chunk = std::min<uint64_t>(PAGE_SIZE, memorySize - uint64_t(n) * PAGE_SIZE);
+        in.getBytes(buffer.data(), chunk);
+        write(uint32_t(uint64_t(n) * PAGE_SIZE), buffer.data(), chunk);
+    }
+}
+
+uint64_t MainMemory::size() const {
+    return memorySize;
+}
+
+size_t MainMemory::residentPages() const {
+    return pages.load(std::memory_order_relaxed);
+}
+
+size_t MainMemory::getBanks() const {
+    return numBanks;
+}
+
+uint64_t MainMemory::getBankAccesses() const {
+    uint64_t total = 0;
+    for (size_t i = 0; i < numBanks; ++i) total += banks[i].accesses;
+    return total;
+}
+
+uint64_t MainMemory::getBankConflictCycles() const {
+    uint64_t total = 0;
+    for (size_t i = 0; i < numBanks; ++i) total += banks[i].conflictCycles;
+    return total;
+}
 
-    std::copy(data.begin(), data.end(), memory.begin() + addr);
+void MainMemory::unmap() {
+    if (mapped) munmap(mapped, memorySize);
+    mapped = nullptr;
 }
@@ -1,76 +1,94 @@
 #include "PE.hpp"   // Incluye el archivo de encabezado de la clase PE
-#include <fstream>  // Para trabajar con archivos (lectura de instrucciones)
+#include <algorithm>
 #include <iostream> // Para entrada/salida estándar (cout, cerr)
-#include <sstream>  // Para manipular strings como streams (istringstream para parsear instrucciones)
 #include <iomanip>  // Para formatear la salida (ej: std::hex para hexadecimal)
 #include <mutex>    // Para la exclusión mutua al imprimir
-
-extern std::mutex cout_mutex; // Mutex global definido en main.cpp
-extern std::mutex cin_mutex; // Mutex global definido en main.cpp
-extern std::mutex execution; // Mutex global definido en main.cpp
-std::mutex cycle;
+#include "Checkpoint.hpp"
 
 // Constructor de la clase PE
-PE::PE(int id, uint8_t qos, Interconnect* interconnect)
+PE::PE(int id, uint8_t qos, Interconnect* interconnect, Simulator* simulator, const CacheConfig& cacheConfig)
     : id(id),                      // Inicializa el ID del PE con el valor proporcionado
       qos(qos),                    // Inicializa la calidad de servicio (QoS) del PE
       interconnect(interconnect),  // Inicializa el puntero al objeto Interconnect
-      outputPath("../output/pe" + std::to_string(id) + ".txt") {} // Inicializa la dirección del txt de salida
-
-// Método para cargar las instrucciones desde un archivo
-void PE::loadInstructions(const std::string& filepath) {
-    std::ifstream file(filepath); // Abre el archivo especificado en modo lectura
-    std::string line;             // Variable para almacenar cada línea leída del archivo
-    while (std::getline(file, line)) { // Lee el archivo línea por línea
-        instructionMemory.push_back(line); // Agrega cada línea (instrucción) al vector instructionMemory
-    }
+      simulator(simulator),        // Inicializa el puntero al kernel de simulación
+      instructionMemory(std::make_shared<InstructionStream>()),
+      cache(cacheConfig, id) {}    // Caché con la geometría configurada (la semilla de reemplazo aleatorio es el ID)
+
+// Método para cargar las instrucciones desde un archivo: se decodifican una sola vez
+bool PE::loadInstructions(const std::string& filepath) {
+    auto program = std::make_shared<InstructionStream>();
+    if (!program->load(filepath)) return false;
+    instructionMemory = std::move(program);
+    return true;
+}
+
+void PE::setProgram(std::shared_ptr<const InstructionStream> program) {
+    instructionMemory = std::move(program);
 }
 
 // Método para imprimir las instrucciones cargadas (principalmente para tests)
 void PE::getInstructions() {
-    for (const auto& instr : instructionMemory) { // Itera a través de cada instrucción en instructionMemory
+    for (size_t i = 0; i < instructionMemory->size(); ++i) { // Itera a través de cada instrucción del programa
         {
-            std::lock_guard<std::mutex> lock(cout_mutex);
-            std::cout << instr << "\n"; // Imprime la instrucción seguida de una nueva línea
+            std::lock_guard<std::mutex> lock(consoleMutex());
+            std::cout << instructionMemory->text(i) << "\n"; // Imprime la instrucción seguida de una nueva línea
         }
     }
 }
 
-// Método para ejecutar una instrucción individual
-void PE::executeInstruction(const std::string& instruction) {
-    std::istringstream iss(instruction); // Crea un stringstream para parsear la instrucción
-    std::string opcode;                 // Variable para almacenar el código de operación (la primera palabra de la instrucción)
-    iss >> opcode;                      // Lee el primer token (opcode) del stringstream
-    std::lock_guard<std::mutex> lock(cycle);
-
-    {
-        std::lock_guard<std::mutex> lock(cin_mutex);
-        std::cin.get(); // Espera a que el usuario presione Enter
-    }
-
-    cycleCounter++;
-
+// Método para ejecutar una instrucción individual (ya decodificada: no se toca texto)
+void PE::executeInstruction(size_t index) {
+    const InstructionStream& program = *instructionMemory;
+    Opcode opcode = program.opcode(index); // Código de operación de la instrucción
 
-    // Si el opcode es "READ_MEM" (operación de lectura de memoria)
-    if (opcode == "READ_MEM") {
-        std::string addr_str; // String para almacenar la dirección (en formato hexadecimal)
-        size_t size;          // Tamaño de los datos a leer
+    stepGate(cycleCounter, id, opcodeName(opcode)); // Espera según el modo de avance configurado
 
-        iss >> addr_str >> size; // Lee la dirección y el tamaño del stringstream
 
-        uint32_t addr = std::stoul(addr_str, nullptr, 16); // Convierte la dirección hexadecimal a un entero sin signo de 32 bits
+    // Si el opcode es READ_MEM (operación de lectura de memoria)
+    if (opcode == Opcode::READ_MEM) {
+        uint32_t addr = program.addr(index);   // Dirección a leer
+        size_t size = program.operand(index);  // Tamaño de los datos a leer
 
         // Primero revisa la caché
         auto result = readFromCache(addr, size); // Intenta leer los datos de la caché
         if (!result.empty()) { // Si el resultado no está vacío (cache hit)
-            {
-                std::lock_guard<std::mutex> lock(cout_mutex);
+            stats.readHits++;
+            if (consoleTrace()) {
+                std::lock_guard<std::mutex> lock(consoleMutex());
                 std::cout << "PE " << id <<  ": Encontrado CACHE HIT Addr 0x"
                           << std::hex << addr << ", " << std::dec << size << " bytes.\n";
-                writeOutput( "READ_MEM 0 0 P" + std::to_string(id) + " " + std::to_string(cycleCounter));
             }
+            writeOutput(traceOp(MessageType::READ_MEM), 0, 0, addr, TracePeer::PE, id);
         } else { // Si la lectura de la caché devuelve un vector vacío (cache miss)
 
+            if (mshrs.enabled()) {
+                MSHRFile::Result mshr = mshrs.allocate(cache.lineOf(addr), cycleCounter);
+                if (mshr == MSHRFile::Result::SECONDARY) { // La línea ya viene en camino: no se envía otro mensaje
+                    stats.readMisses++;
+                    if (consoleTrace()) {
+                        std::lock_guard<std::mutex> lock(consoleMutex());
+                        std::cout << "PE " << id << ": CACHE MISS Addr 0x" << std::hex << addr
+                                  << " combinado con un fallo pendiente\n";
+                    }
+                    return;
+                }
+                if (mshr == MSHRFile::Result::FULL) { // Sin MSHR libre: se detiene y reintenta la instrucción
+                    if (consoleTrace()) {
+                        std::lock_guard<std::mutex> lock(consoleMutex());
+                        std::cout << "PE " << id << ": MSHRs llenos, detenido en Addr 0x" << std::hex << addr << "\n";
+                    }
+                    instructionPointer--;
+                    stalled = true;
+                    stallStart = cycleCounter;
+                    return;
+                }
+            }
+
+            stats.readMisses++;
+
+            // Una escritura combinada de la línea sale antes que la lectura (si no, la memoria estaría atrasada)
+            if (writeCombining.enabled() && writeCombining.drain(addr, combinedLines)) flushCombined();
+
             // Construir y enviar mensaje de READ_MEM al Interconnect
             Message msg;
             msg.type = MessageType::READ_MEM;  // Establece el tipo de mensaje a READ_MEM
@@ -78,32 +96,76 @@ void PE::executeInstruction(const std::string& instruction) {
             msg.qos = qos;                     // Establece la calidad de servicio del mensaje
             msg.addr = addr;                   // Establece la dirección de memoria a leer
             msg.size = size;                   // Establece el tamaño de los datos a leer
+            msg.cycle = cycleCounter;          // Ciclo de emisión del mensaje
 
-            {
-                std::lock_guard<std::mutex> lock(cout_mutex);
+            if (consoleTrace()) {
+                std::lock_guard<std::mutex> lock(consoleMutex());
                 std::cout << "PE " << id << ": Encontrado CACHE MISS Addr 0x"
                           << std::hex << addr << "\n";
                 std::cout << "PE " << id << ": Solicitud READ_MEM a IntConnect Addr 0x"
                           << std::hex << addr << "\n";
-                writeOutput( "READ_MEM 1 " +
-                                std::to_string(6) + " IC " + std::to_string(cycleCounter));
             }
+            writeOutput(traceOp(MessageType::READ_MEM), 1, 6, addr);
 
-            interconnect->sendMessage(msg); // Envía el mensaje al Interconnect
+            outbox.push_back(msg); // Se envía al Interconnect en la fase de commit
         }
 
     }
-    // Si el opcode es "WRITE_MEM" (operación de escritura en memoria)
-    else if (opcode == "WRITE_MEM") {
-        std::string addr_str;   // String para almacenar la dirección (en formato hexadecimal)
-        size_t num_lines;       // Número de líneas de caché a escribir
-        iss >> addr_str >> num_lines; // Lee la dirección y el número de líneas del stringstream
-
-        uint32_t addr = std::stoul(addr_str, nullptr, 16); // Convierte la dirección hexadecimal a un entero sin signo de 32 bits
-        std::vector<uint8_t> concatenated_data;
+    // Si el opcode es WRITE_MEM (operación de escritura en memoria)
+    else if (opcode == Opcode::WRITE_MEM) {
+        uint32_t addr = program.addr(index);        // Dirección a escribir
+        size_t num_lines = program.operand(index);  // Número de líneas de caché a escribir
+        if (4 * num_lines > Payload::CAPACITY) {
+            std::cerr << "PE " << id << ": WRITE_MEM de " << num_lines << " líneas excede " << Payload::CAPACITY
+                      << " bytes, se trunca.\n";
+        }
 
-        std::vector<uint8_t> simulate_data(4 * num_lines, id); // Simula datos para la informacion enviada
-        writeToCache(addr, simulate_data);       // Escribe los datos simulados en la caché
+        Payload simulate_data;
+        simulate_data.assign(4 * num_lines, uint8_t(id)); // Simula datos para la informacion enviada
+        stats.writes++;
+
+        if (protocol != CoherenceProtocol::NONE) {
+            // Con protocolo solo se escribe localmente una línea propia (E o M); si no, el WRITE_MEM
+            // pide la línea en exclusiva y el interconnect la instala ya escrita
+            CacheBlock* block = cache.lookup(addr);
+            if (block && block->readyCycle <= cycleCounter &&
+                (block->state == CoherenceState::EXCLUSIVE || block->state == CoherenceState::MODIFIED)) {
+                copyIntoLine(*block, addr, simulate_data);
+                block->state = CoherenceState::MODIFIED;
+                stats.writeHits++;
+                if (consoleTrace()) {
+                    std::lock_guard<std::mutex> lock(consoleMutex());
+                    std::cout << "PE " << id << ": Escritura local Addr 0x" << std::hex << addr
+                              << " (línea propia, " << std::dec << num_lines << " Lineas)\n";
+                }
+                writeOutput(traceOp(MessageType::WRITE_MEM), 0, 0, addr, TracePeer::PE, id);
+                return;
+            }
+        } else if (cache.getConfig().writePolicy == WritePolicy::WRITE_BACK) {
+            // Write-back: la línea queda sucia y llega a memoria al reemplazarla o invalidarla
+            writeDirty(addr, simulate_data);
+            if (consoleTrace()) {
+                std::lock_guard<std::mutex> lock(consoleMutex());
+                std::cout << "PE " << id << ": Escritura en Caché Conjunto 0x" << std::hex << cache.setOf(addr)
+                          << " (" << std::dec << num_lines << " Lineas, write-back)\n";
+            }
+            writeOutput(traceOp(MessageType::WRITE_MEM), 0, 0, addr, TracePeer::PE, id);
+            return;
+        } else {
+            writeToCache(addr, simulate_data);       // Escribe los datos simulados en la caché
+            if (writeCombining.enabled()) {
+                // La escritura se combina con las demás de su línea; sale cuando la entrada deja el buffer
+                writeCombining.write(addr, simulate_data.data(), simulate_data.size(), combinedLines);
+                if (consoleTrace()) {
+                    std::lock_guard<std::mutex> lock(consoleMutex());
+                    std::cout << "PE " << id << ": Escritura en Caché Conjunto 0x" << std::hex << cache.setOf(addr)
+                              << " (" << std::dec << num_lines << " Lineas, al buffer de write-combining)\n";
+                }
+                writeOutput(traceOp(MessageType::WRITE_MEM), 0, 0, addr, TracePeer::PE, id);
+                flushCombined();
+                return;
+            }
+        }
 
         // Construir y enviar mensaje de WRITE_MEM al Interconnect
         Message msg;
@@ -112,26 +174,40 @@ void PE::executeInstruction(const std::string& instruction) {
         msg.qos = qos;                      // Establece la calidad de servicio del mensaje
         msg.addr = addr;                    // Establece la dirección de memoria a escribir
         msg.data = simulate_data;           // Establece los datos a escribir
+        msg.cycle = cycleCounter;           // Ciclo de emisión del mensaje
 
-        {
-            std::lock_guard<std::mutex> lock(cout_mutex);
-            std::cout << "PE " << id << ": Escritura en Caché Addr 0x" << std::hex << addr % NUM_BLOCKS
+        if (consoleTrace()) {
+            std::lock_guard<std::mutex> lock(consoleMutex());
+            std::cout << "PE " << id << ": Escritura en Caché Conjunto 0x" << std::hex << cache.setOf(addr)
                     << " (" << std::dec << num_lines << " Lineas) \n";
             std::cout << "PE " << id << ": Solicitud WRITE Addr 0x" << std::hex << addr
                     << " (" << std::dec << num_lines << " Lineas) \n";
-            writeOutput( "WRITE_MEM 1 " +
-                            std::to_string(6 + msg.data.size()) + " IC " + std::to_string(cycleCounter));
         }
+        writeOutput(traceOp(MessageType::WRITE_MEM), 1, 6 + msg.data.size(), addr);
 
-        interconnect->sendMessage(msg); // Envía el mensaje al Interconnect
+        outbox.push_back(msg); // Se envía al Interconnect en la fase de commit
 
     }
-    // Si el opcode es "BROADCAST_INVALIDATE" (operación de invalidación de caché)
-    else if (opcode == "BROADCAST_INVALIDATE") {
-        std::string cache_line_str; // String para almacenar la línea de caché a invalidar (en formato hexadecimal)
-        iss >> cache_line_str;      // Lee la línea de caché del stringstream
+    // Si el opcode es BROADCAST_INVALIDATE (operación de invalidación de caché)
+    else if (opcode == Opcode::BROADCAST_INVALIDATE) {
+        uint32_t cache_line = program.addr(index); // Línea de caché a invalidar
+
+        // Con protocolo las escrituras ya invalidan las demás copias: la instrucción no genera tráfico
+        if (protocol != CoherenceProtocol::NONE) {
+            if (consoleTrace()) {
+                std::lock_guard<std::mutex> lock(consoleMutex());
+                std::cout << "PE " << id << ": Broadcast Invalidate Addr 0x" << std::hex << cache_line
+                          << " omitido (coherencia " << coherenceProtocolName(protocol) << ")\n";
+            }
+            return;
+        }
 
-        uint32_t cache_line = std::stoul(cache_line_str, nullptr, 16); // Convierte la línea de caché hexadecimal a un entero sin signo de 32 bits
+        // Los datos propios de la línea llegan a memoria antes de que los demás PEs la vuelvan a leer
+        if (writeCombining.enabled() && writeCombining.drain(cache_line, combinedLines)) flushCombined();
+        if (CacheBlock* block = cache.probe(cache_line); block && isDirty(block->state)) {
+            writeBackLine(*block);
+            stats.invalidationFlushes++;
+        }
 
         // Construir y enviar mensaje de BROADCAST_INVALIDATE al Interconnect
         Message msg;
@@ -139,191 +215,511 @@ void PE::executeInstruction(const std::string& instruction) {
         msg.src = id;                                 // Establece la fuente del mensaje como el ID del PE
         msg.qos = qos;                                // Establece la calidad de servicio del mensaje
         msg.addr = cache_line;                        // Establece la línea de caché a invalidar
+        msg.cycle = cycleCounter;                     // Ciclo de emisión del mensaje
 
-        {
-            std::lock_guard<std::mutex> lock(cout_mutex);
+        if (consoleTrace()) {
+            std::lock_guard<std::mutex> lock(consoleMutex());
             std::cout << "PE " << id << ": Solicitud Broadcast Invalidate Addr 0x"
                     << std::hex << cache_line << "\n";
-            writeOutput( "BROADCAST_INVALIDATE 1 " +
-                std::to_string(6) + " IC " + std::to_string(cycleCounter));
         }
+        writeOutput(traceOp(MessageType::BROADCAST_INVALIDATE), 1, 6, cache_line);
 
-        interconnect->sendMessage(msg); // Envía el mensaje al Interconnect
+        outbox.push_back(msg); // Se envía al Interconnect en la fase de commit
     }
     // Si el opcode no coincide con ninguna instrucción conocida
     else {
-        {
-            std::lock_guard<std::mutex> lock(cout_mutex);
-            std::cout << "PE " << id << ": Instrucción desconocida → " << instruction << "\n";
-            writeOutput( "UNKNOWN 0 0 P" + std::to_string(id) + " " + std::to_string(cycleCounter));
+        if (consoleTrace()) {
+            std::lock_guard<std::mutex> lock(consoleMutex());
+            std::cout << "PE " << id << ": Instrucción desconocida → " << program.text(index) << "\n";
         }
+        writeOutput(TRACE_OP_UNKNOWN, 0, 0, 0, TracePeer::PE, id);
     }
 }
 
 // Método para recibir un mensaje de respuesta del Interconnect
 void PE::receiveResponse(const Message& msg) {
-    // Bloque protegido por un mutex para acceder de forma segura a la responseQueue
-    {
-        std::lock_guard<std::mutex> lock(responseMutex); // Adquiere un lock del mutex al entrar al bloque, se libera automáticamente al salir
-        responseQueue.push(msg);                      // Agrega el mensaje recibido a la cola de respuestas
-    }
-    responseCV.notify_one(); // Notifica a un thread que esté esperando en la condition variable que hay un nuevo mensaje
+    receiveResponse(Message(msg));
 }
 
-// Método para manejar las respuestas recibidas del Interconnect
-void PE::handleResponses() {
-    std::unique_lock<std::mutex> lock(responseMutex); // Adquiere un unique lock del mutex, permite esperas condicionales
+// El interconnect es el único productor de la bandeja: se publica sin locks
+void PE::receiveResponse(Message&& msg) {
+    inbox.push(std::move(msg));
+}
 
-    {
-        std::lock_guard<std::mutex> lock(cycle);
-        cycleCounter++;
+// Método para manejar las respuestas recibidas del Interconnect: vacía de una vez todas las que ya
+// llegaron en el ciclo actual (el PE es el único consumidor de su bandeja)
+void PE::handleResponses() {
+    // La bandeja está en orden de entrega, no de llegada: todo pasa al heap ordenado por ciclo
+    while (Message* next = inbox.front()) {
+        arriving.push_back(ArrivingResponse{arrivalOrder++, std::move(*next)});
+        std::push_heap(arriving.begin(), arriving.end(), LaterArrival());
+        inbox.pop();
     }
 
-    // Mientras la cola de respuestas no esté vacía
-    while (!responseQueue.empty()) {
+    // Mientras haya respuestas cuyo ciclo de llegada ya se alcanzó, de la más temprana a la más tardía
+    while (!arriving.empty() && arriving.front().msg.cycle <= cycleCounter) {
+        stepGate(cycleCounter, id, messageTypeName(arriving.front().msg.type)); // Espera según el modo de avance configurado
 
-        {
-            std::lock_guard<std::mutex> lock(cin_mutex);
-            std::cin.get(); // Espera a que el usuario presione Enter
-        }
-
-        Message msg = responseQueue.front(); // Obtiene el mensaje del frente de la cola
-        responseQueue.pop();                 // Remueve el mensaje del frente de la cola
-        lock.unlock();                       // Libera el lock para permitir que otros threads (ej: el que llama a receiveResponse) accedan a la cola
+        std::pop_heap(arriving.begin(), arriving.end(), LaterArrival());
+        Message msg = std::move(arriving.back().msg); // Extrae la respuesta más temprana
+        arriving.pop_back();
+        stats.received.add(msg);
 
         // Si el tipo de mensaje es READ_RESP (respuesta a una lectura de memoria)
         if (msg.type == MessageType::READ_RESP) {
-            {
-                std::lock_guard<std::mutex> lock(cout_mutex);
+            if (consoleTrace()) {
+                std::lock_guard<std::mutex> lock(consoleMutex());
                 std::cout << "PE " << id << ": Recibido READ_RESP Actualizado Linea Caché Addr 0x"
                           << std::hex << msg.addr << "\n";
-                writeOutput( "READ_RESP 0 " +
-                                std::to_string(6 + msg.data.size()) + " IC " + std::to_string(cycleCounter));
             }
-            writeToCache(msg.addr, msg.data); // Escribe los datos recibidos en la caché
+            writeOutput(traceOp(MessageType::READ_RESP), 0, 6 + msg.data.size(), msg.addr);
+            // Escribe los datos recibidos en la caché (con protocolo el interconnect ya instaló la línea;
+            // con write-back una línea sucia es más nueva que la respuesta y se conserva)
+            CacheBlock* present = cache.probe(msg.addr);
+            if (protocol == CoherenceProtocol::NONE && !(present && isDirty(present->state))) {
+                writeToCache(msg.addr, msg.data);
+            }
+            if (mshrs.release(cache.lineOf(msg.addr), cycleCounter) && stalled && !resumeIssue) {
+                resumeIssue = true; // Hay un MSHR libre para la instrucción detenida
+                stallCycles += cycleCounter - stallStart;
+            }
         }
         // Si el tipo de mensaje es WRITE_RESP (respuesta a una escritura en memoria)
         else if (msg.type == MessageType::WRITE_RESP) {
 
-            {
-                std::lock_guard<std::mutex> lock(cout_mutex);
+            if (consoleTrace()) {
+                std::lock_guard<std::mutex> lock(consoleMutex());
                 std::cout << "PE " << id << ": Recibido WRITE_RESP Escritura Confirmada\n";
-                writeOutput( "WRITE_RESP 0 " +
-                                std::to_string(3) + " IC " + std::to_string(cycleCounter));
             }
-
-            writeToCache(msg.addr, msg.data);
+            writeOutput(traceOp(MessageType::WRITE_RESP), 0, 3 + msg.data.size(), msg.addr);
+            // La línea ya se escribió en caché al emitir el WRITE_MEM (o, con protocolo, al concederla)
         }
         // Si el tipo de mensaje es INV_ACK (respuesta a una invalidación)
         else if (msg.type == MessageType::INV_ACK) {
-            {
-                std::lock_guard<std::mutex> lock(cout_mutex);
+            if (consoleTrace()) {
+                std::lock_guard<std::mutex> lock(consoleMutex());
                 std::cout << "PE " << id << ": Recibido INV_ACK del PE " << int(msg.src) << "\n";
-                writeOutput( "INV_ACK 0 " +
-                                std::to_string(2) + " IC " + std::to_string(cycleCounter));
             }
+            writeOutput(traceOp(MessageType::INV_ACK), 0, 2, msg.addr);
         }
         // Si el tipo de mensaje es INV_COMPLETE (indicación de que todas las invalidaciones fueron completadas)
         else if (msg.type == MessageType::INV_COMPLETE) {
-            {
-                std::lock_guard<std::mutex> lock(cout_mutex);
+            if (consoleTrace()) {
+                std::lock_guard<std::mutex> lock(consoleMutex());
                 std::cout << "PE " << id << ": Recibido INV_COMPLETE. Invalidaciones completadas.\n";
-                writeOutput( "INV_COMPLETE 0 " +
-                                std::to_string(2) + " IC " + std::to_string(cycleCounter));
             }
+            writeOutput(traceOp(MessageType::INV_COMPLETE), 0, 2, msg.addr);
         }
         // Si el tipo de mensaje no es reconocido
         else {
-            {
-                std::lock_guard<std::mutex> lock(cout_mutex);
+            if (consoleTrace()) {
+                std::lock_guard<std::mutex> lock(consoleMutex());
                 std::cout << "PE " << id << ": Recibió tipo de mensaje inesperado: " << static_cast<int>(msg.type) << "\n";
-                writeOutput( "UNKNOWN 0 " +
-                                std::to_string(2) + " IC " + std::to_string(cycleCounter));
             }
+            writeOutput(TRACE_OP_UNKNOWN, 0, 2, msg.addr);
         }
-
-        lock.lock(); // Readquiere el lock antes de la siguiente iteración del bucle
     }
 }
 
-// Método para iniciar la ejecución del PE en un nuevo thread
+// Método para iniciar la ejecución del PE: agenda la primera instrucción en el ciclo 1
 void PE::start() {
-    thread = std::thread(&PE::execute, this); // Crea un nuevo thread que ejecutará la función 'execute' de este objeto PE
+    if (instructionMemory->empty()) {
+        complete = true;
+        return;
+    }
+    simulator->schedule(1, EventType::PE_ISSUE, this);
 }
 
-// Método para esperar a que el thread del PE termine su ejecución
-void PE::join() {
-    if (thread.joinable()) // Verifica si el thread puede ser unido (si aún no ha terminado)
-        thread.join();     // Espera a que el thread termine
+// Punto de entrada de los eventos del kernel de simulación.
+// PE_ISSUE puede ejecutarse en paralelo con otros PEs: solo modifica el estado propio del PE.
+void PE::handleEvent(EventType type, uint64_t now) {
+    cycleCounter = now; // El reloj local del PE avanza con los eventos que procesa
+
+    if (type == EventType::RESPONSE_DELIVERY) {
+        handleResponses();
+        return;
+    }
+
+    // PE_ISSUE: emite una instrucción por ciclo hasta terminar el programa
+    size_t index = instructionPointer++;
+    if (consoleTrace()) {
+        std::lock_guard<std::mutex> lock(consoleMutex());
+        std::cout << "PE " << id << ": Instrucción → " << instructionMemory->text(index) << "\n";
+    }
+
+    executeInstruction(index); // Ejecuta la instrucción actual
 }
 
-// Método que contiene el bucle principal de ejecución del PE
-void PE::execute() {
-    for (const auto& instr : instructionMemory) { // Itera a través de cada instrucción cargada en la memoria de instrucciones
-        {
-            std::lock_guard<std::mutex> lock(cin_mutex);
-            std::cin.get(); // Espera a que el usuario presione Enter
+// Fase secuencial de la emisión: envía los mensajes generados y agenda la siguiente instrucción
+void PE::commitEvent(EventType type, uint64_t now) {
+    if (type == EventType::RESPONSE_DELIVERY) {
+        sendOutbox(); // Write-backs de las líneas reemplazadas por las respuestas
+        if (resumeIssue) {
+            resumeIssue = false;
+            stalled = false;
+            simulator->schedule(now + 1, EventType::PE_ISSUE, this);
         }
+        return;
+    }
 
-        {
-            std::lock_guard<std::mutex> lock(cout_mutex);
-            std::cout << "PE " << id << ": Instrucción → " << instr << "\n";
+    // Al terminar el programa el buffer de write-combining se vacía
+    if (!stalled && instructionPointer >= instructionMemory->size() && !writeCombining.empty()) {
+        writeCombining.drainAll(combinedLines);
+        flushCombined();
+    }
+    sendOutbox();
+
+    if (stalled) return; // Se reanuda cuando una respuesta libere un MSHR
+
+    if (instructionPointer < instructionMemory->size()) {
+        // Con muestreo la ventana detallada termina en issueLimit; la próxima la agenda runDetailed
+        if (instructionPointer < issueLimit) simulator->schedule(now + 1, EventType::PE_ISSUE, this);
+        else simulator->closeMeasurement(now);
+    } else {
+        complete = true;
+        if (issueLimit != SIZE_MAX) simulator->closeMeasurement(now);
+    }
+}
+
+// Avance rápido: los mismos efectos que executeInstruction y la respuesta correspondiente, en el acto
+bool PE::fastForward() {
+    const InstructionStream& program = *instructionMemory;
+    if (instructionPointer >= program.size()) {
+        complete = true;
+        return false;
+    }
+    fastForwarding = true;
+    size_t index = instructionPointer++;
+    Opcode opcode = program.opcode(index);
+    uint32_t addr = program.addr(index);
+
+    if (opcode == Opcode::READ_MEM) {
+        size_t size = program.operand(index);
+        if (!readFromCache(addr, size).empty()) {
+            stats.readHits++;
+        } else {
+            stats.readMisses++;
+            if (writeCombining.enabled() && writeCombining.drain(addr, combinedLines)) flushCombined();
+            Message msg;
+            msg.type = MessageType::READ_MEM;
+            msg.src = id;
+            msg.addr = addr;
+            msg.size = size;
+            interconnect->functionalAccess(msg); // Con protocolo ya instala la línea
+            CacheBlock* present = cache.probe(addr);
+            if (protocol == CoherenceProtocol::NONE && !(present && isDirty(present->state))) {
+                writeToCache(addr, msg.data);
+            }
         }
+    } else if (opcode == Opcode::WRITE_MEM) {
+        Payload data;
+        data.assign(4 * program.operand(index), uint8_t(id));
+        stats.writes++;
+        if (protocol != CoherenceProtocol::NONE) {
+            CacheBlock* block = cache.lookup(addr);
+            if (block && (block->state == CoherenceState::EXCLUSIVE || block->state == CoherenceState::MODIFIED)) {
+                copyIntoLine(*block, addr, data);
+                block->state = CoherenceState::MODIFIED;
+                stats.writeHits++;
+            } else {
+                Message msg;
+                msg.type = MessageType::WRITE_MEM;
+                msg.src = id;
+                msg.addr = addr;
+                msg.data = data;
+                interconnect->functionalAccess(msg);
+            }
+        } else if (cache.getConfig().writePolicy == WritePolicy::WRITE_BACK) {
+            writeDirty(addr, data);
+        } else {
+            writeToCache(addr, data);
+            if (writeCombining.enabled()) {
+                writeCombining.write(addr, data.data(), data.size(), combinedLines);
+                flushCombined();
+            } else {
+                sendWrite(addr, data.data(), data.size());
+            }
+        }
+    } else if (opcode == Opcode::BROADCAST_INVALIDATE && protocol == CoherenceProtocol::NONE) {
+        if (writeCombining.enabled() && writeCombining.drain(addr, combinedLines)) flushCombined();
+        if (CacheBlock* block = cache.probe(addr); block && isDirty(block->state)) {
+            writeBackLine(*block);
+            stats.invalidationFlushes++;
+        }
+        Message msg;
+        msg.type = MessageType::BROADCAST_INVALIDATE;
+        msg.src = id;
+        msg.addr = addr;
+        interconnect->functionalAccess(msg);
+    }
+
+    if (instructionPointer >= program.size()) { // Al terminar el programa el buffer de write-combining se vacía
+        if (!writeCombining.empty()) {
+            writeCombining.drainAll(combinedLines);
+            flushCombined();
+        }
+        complete = true;
+    }
+    reportAllocatedLines();
+    fastForwarding = false;
+    return true;
+}
+
+bool PE::runDetailed(size_t count) {
+    if (complete || instructionPointer >= instructionMemory->size()) {
+        complete = true;
+        return false;
+    }
+    issueLimit = instructionPointer + count;
+    simulator->schedule(simulator->now() + 1, EventType::PE_ISSUE, this);
+    return true;
+}
 
-        executeInstruction(instr); // Ejecuta la instrucción actual
+void PE::sendOutbox() {
+    reportAllocatedLines(); // Antes que los mensajes: el directorio ya conoce la copia al conceder el WRITE_MEM
+    for (auto& msg : outbox) {
+        stats.sent.add(msg);
+        interconnect->sendMessage(std::move(msg)); // Envía los mensajes al Interconnect
     }
-    complete = true;
+    outbox.clear();
+}
+
+// La caché se escribe en la fase paralela; el directorio es compartido y se actualiza en la de commit
+void PE::reportAllocatedLines() {
+    for (uint32_t addr : allocatedLines) interconnect->recordSharer(uint16_t(id), addr);
+    allocatedLines.clear();
+}
+
+void PE::setMSHRs(size_t count) {
+    mshrs.setCapacity(count);
+}
+
+void PE::setCoherenceProtocol(CoherenceProtocol protocol) {
+    this->protocol = protocol;
+}
+
+void PE::setWriteCombining(size_t entries) {
+    writeCombining.configure(entries, uint32_t(cache.getConfig().lineSize));
 }
 
 // Método para escribir datos en la caché del PE
-void PE::writeToCache(uint32_t addr, const std::vector<uint8_t>& data) {
-    size_t blockIndex = (addr / 16) % NUM_BLOCKS; // Calcula el índice del bloque de caché usando la dirección y el tamaño del bloque
-    cache[blockIndex].tag = addr / 16;           // Almacena la etiqueta (parte superior de la dirección) en el bloque de caché
-    // Copia los datos al bloque de caché, asegurándose de no escribir más allá del tamaño del bloque (16 bytes)
-    std::copy(data.begin(), data.begin() + std::min(data.size(), size_t(16)), cache[blockIndex].data.begin());
-    cache[blockIndex].valid = true;              // Marca el bloque de caché como válido
+void PE::writeToCache(uint32_t addr, const Payload& data) {
+    CacheBlock& block = allocateLine(addr);      // Bloque de la línea (hit) o víctima según la política de reemplazo
+    copyIntoLine(block, addr, data);
+    block.state = CoherenceState::SHARED;        // Marca el bloque de caché como válido
+}
+
+// Copia los datos al bloque de caché desde la posición de addr, sin escribir más allá del final de la línea
+void PE::copyIntoLine(CacheBlock& block, uint32_t addr, const Payload& data) {
+    uint32_t offset = cache.offsetOf(addr);
+    size_t count = std::min(data.size(), cache.getConfig().lineSize - offset);
+    std::copy(data.begin(), data.begin() + count, block.data.begin() + offset);
+}
+
+void PE::writeDirty(uint32_t addr, const Payload& data) {
+    CacheBlock& block = allocateLine(addr);
+    copyIntoLine(block, addr, data);
+    uint32_t offset = cache.offsetOf(addr);
+    size_t count = std::min(data.size(), cache.getConfig().lineSize - offset);
+    block.dirtyMask |= (count >= 64 ? ~uint64_t(0) : (uint64_t(1) << count) - 1) << offset;
+    block.state = CoherenceState::MODIFIED;
+}
+
+CacheBlock& PE::allocateLine(uint32_t addr) {
+    CacheBlock evicted;
+    CacheBlock& block = cache.allocate(addr, evicted);
+    if (isDirty(evicted.state)) {
+        writeBackLine(evicted);
+        stats.writebacks++;
+    }
+    allocatedLines.push_back(addr);
+    return block;
+}
+
+// Write-back sin protocolo: solo los bytes modificados viajan (un WRITE_MEM por tramo contiguo)
+void PE::writeBackLine(CacheBlock& block) {
+    uint32_t lineAddr = uint32_t(block.tag * cache.getConfig().lineSize);
+    forEachByteRun(block.dirtyMask, [&](uint32_t offset, uint32_t count) {
+        sendWrite(lineAddr + offset, block.data.data() + offset, count);
+    });
+    block.dirtyMask = 0;
+    block.state = CoherenceState::SHARED;
+}
+
+// Envía las entradas que salieron del buffer de write-combining: un WRITE_MEM por tramo escrito
+void PE::flushCombined() {
+    for (const WriteCombiningEntry& entry : combinedLines) {
+        forEachByteRun(entry.mask, [&](uint32_t offset, uint32_t count) {
+            sendWrite(entry.line + offset, entry.data.data() + offset, count);
+        });
+    }
+    combinedLines.clear();
+}
+
+void PE::sendWrite(uint32_t addr, const uint8_t* data, size_t size) {
+    Message msg;
+    msg.type = MessageType::WRITE_MEM;
+    msg.src = id;
+    msg.qos = qos;
+    msg.addr = addr;
+    msg.data.assign(data, size);
+    msg.cycle = cycleCounter;
+    if (fastForwarding) {
+        interconnect->functionalAccess(msg);
+        return;
+    }
+
+    if (consoleTrace()) {
+        std::lock_guard<std::mutex> lock(consoleMutex());
+        std::cout << "PE " << id << ": Solicitud WRITE Addr 0x" << std::hex << addr
+                  << " (" << std::dec << size << " bytes desde la caché)\n";
+    }
+    writeOutput(traceOp(MessageType::WRITE_MEM), 1, 6 + msg.data.size(), addr);
+    outbox.push_back(msg);
 }
 
 // Método para leer datos de la caché del PE
-std::vector<uint8_t> PE::readFromCache(uint32_t addr, size_t size) {
-    size_t blockIndex = (addr / 16) % NUM_BLOCKS; // Calcula el índice del bloque de caché
-    // Verifica si el bloque de caché es válido y si la etiqueta coincide con la dirección solicitada
-    if (cache[blockIndex].valid && cache[blockIndex].tag == addr / 16) {
-        // Si hay un cache hit, devuelve un vector de bytes con los datos solicitados
-        return std::vector<uint8_t>(cache[blockIndex].data.begin(), cache[blockIndex].data.begin() + size);
+Payload PE::readFromCache(uint32_t addr, size_t size) {
+    CacheBlock* block = cache.lookup(addr); // Busca la línea en todas las vías de su conjunto
+    if (block && block->readyCycle <= cycleCounter) { // Una línea concedida cuya respuesta no llegó aún es un miss
+        // Si hay un cache hit, devuelve los datos solicitados (sin pasar del final de la línea)
+        uint32_t offset = cache.offsetOf(addr);
+        Payload result;
+        result.assign(block->data.data() + offset, std::min(size, cache.getConfig().lineSize - offset));
+        return result;
     } else {
-        // Si hay un cache miss, devuelve un vector vacío
+        // Si hay un cache miss, devuelve una carga vacía
         return {};
     }
 }
 
 // Método para invalidar una línea específica de la caché del PE
 void PE::invalidateCacheLine(uint32_t addr) { // Cambiado el nombre del parámetro a addr para mayor claridad
-    size_t blockIndex = (addr / 16) % NUM_BLOCKS; // Calcula el índice del bloque de caché usando la dirección
-    // Verifica si la línea de caché es válida y si la etiqueta coincide
-    if (cache[blockIndex].valid && cache[blockIndex].tag == addr / 16) {
-        cache[blockIndex].valid = false; // Marca la línea de caché como inválida
-        {
-            std::lock_guard<std::mutex> lock(cout_mutex);
+    stats.invalidationsReceived++;
+    // Verifica si la línea de caché es válida y si la etiqueta coincide en alguna vía
+    if (cache.invalidate(addr)) {
+        stats.invalidationsUseful++;
+        if (consoleTrace()) {
+            std::lock_guard<std::mutex> lock(consoleMutex());
             std::cout << "PE " << id << ": Línea Caché 0x" << std::hex << addr << " Invalidada.\n";
         }
     } else {
         // No hace nada si la línea no es válida o la etiqueta no coincide
-        {
-            std::lock_guard<std::mutex> lock(cout_mutex);
+        if (consoleTrace()) {
+            std::lock_guard<std::mutex> lock(consoleMutex());
             std::cout << "PE " << id << ": Línea Caché 0x" << std::hex << addr << " no encontrada o ya inválida.\n";
         }
     }
 }
 
-// Método para agregar una línea al final de un archivo
-void PE::writeOutput(const std::string& line) {
-    std::ofstream file(outputPath, std::ios::app); // Abre el archivo en modo append
-    if (file.is_open()) {
-        file << line << '\n'; // Escribe la línea con salto de línea
+CacheBlock* PE::snoopLine(uint32_t addr) {
+    return cache.probe(addr);
+}
+
+// Reserva la línea con el estado concedido; no se puede leer hasta que llegue la respuesta
+CacheBlock& PE::installLine(uint32_t addr, CoherenceState state, CacheBlock& evicted) {
+    CacheBlock& block = cache.allocate(addr, evicted);
+    block.state = state;
+    block.readyCycle = UINT64_MAX;
+    return block;
+}
+
+void PE::setLineReady(uint32_t addr, uint64_t cycle) {
+    CacheBlock* block = cache.probe(addr);
+    if (block && block->readyCycle == UINT64_MAX) block->readyCycle = cycle; // Pudo invalidarse mientras viajaba
+}
+
+// Escribe en memoria las líneas en M u O y las deja limpias. Devuelve cuántas volcó.
+size_t PE::writeBackDirtyLines(MainMemory& memory) {
+    size_t lineSize = cache.getConfig().lineSize;
+    size_t count = 0;
+    cache.forEachValid([&](CacheBlock& block) {
+        if (!isDirty(block.state)) return;
+        uint32_t lineAddr = uint32_t(block.tag * lineSize);
+        if (protocol == CoherenceProtocol::NONE) { // Write-back: la línea no se trajo de memoria, solo valen los bytes escritos
+            forEachByteRun(block.dirtyMask, [&](uint32_t offset, uint32_t bytes) {
+                memory.write(lineAddr + offset, block.data.data() + offset, bytes);
+            });
+            block.dirtyMask = 0;
+            block.state = CoherenceState::SHARED;
+        } else {
+            memory.write(lineAddr, block.data.data(), lineSize);
+            block.state = block.state == CoherenceState::MODIFIED ? CoherenceState::EXCLUSIVE : CoherenceState::SHARED;
+        }
+        count++;
+    });
+    return count;
+}
+
+void PE::saveState(CheckpointWriter& out) const {
+    out.put<uint64_t>(instructionMemory->size()); // Para detectar un programa distinto al restaurar
+    out.put<uint64_t>(instructionPointer);
+    out.put(cycleCounter);
+    out.put(uint8_t(complete));
+    out.put(uint8_t(stalled));
+    out.put(uint8_t(resumeIssue));
+    out.put(stallStart);
+    out.put(stallCycles);
+    out.put(stats);
+    cache.saveState(out);
+    mshrs.saveState(out);
+    writeCombining.saveState(out);
+
+    // Entre eventos outbox está vacío; las respuestas ya entregadas esperan en el heap (en orden de
+    // llegada) o en la bandeja. Al restaurar todas vuelven a la bandeja en ese mismo orden.
+    out.put<uint64_t>(outbox.size());
+    for (const Message& msg : outbox) out.putMessage(msg);
+    std::vector<ArrivingResponse> sorted = arriving;
+    std::sort(sorted.begin(), sorted.end(), [](const ArrivingResponse& a, const ArrivingResponse& b) {
+        return LaterArrival()(b, a);
+    });
+    uint64_t pending = sorted.size();
+    inbox.forEach([&](const Message&) { pending++; });
+    out.put(pending);
+    for (const ArrivingResponse& response : sorted) out.putMessage(response.msg);
+    inbox.forEach([&](const Message& msg) { out.putMessage(msg); });
+}
+
+void PE::loadState(CheckpointReader& in) {
+    if (in.get<uint64_t>() != instructionMemory->size()) in.fail();
+    instructionPointer = size_t(in.get<uint64_t>());
+    if (instructionPointer > instructionMemory->size()) in.fail();
+    in.get(cycleCounter);
+    complete = in.get<uint8_t>() != 0;
+    stalled = in.get<uint8_t>() != 0;
+    resumeIssue = in.get<uint8_t>() != 0;
+    in.get(stallStart);
+    in.get(stallCycles);
+    in.get(stats);
+    cache.loadState(in);
+    mshrs.loadState(in);
+    writeCombining.loadState(in);
+
+    outbox.resize(size_t(std::min<uint64_t>(in.get<uint64_t>(), in.remaining())));
+    for (Message& msg : outbox) in.getMessage(msg);
+    uint64_t pending = in.get<uint64_t>();
+    for (uint64_t i = 0; i < pending && in.ok(); ++i) {
+        Message msg;
+        in.getMessage(msg);
+        inbox.push(std::move(msg));
     }
 }
 
+// Método para registrar una línea en el archivo de salida del PE (la escribe el hilo de trazas)
+void PE::writeOutput(uint8_t op, uint8_t direction, size_t size, uint32_t addr, TracePeer peer, uint16_t peerId) {
+    TraceWriter* trace = simulator->getTraceWriter();
+    if (!trace) return;
+    TraceRecord rec;
+    rec.cycle = cycleCounter;
+    rec.addr = addr;
+    rec.size = uint16_t(size);
+    rec.peer = peerId;
+    rec.op = op;
+    rec.direction = direction;
+    rec.peerKind = peer;
+    trace->record(TraceWriter::peStream(id), rec);
+}
+
 // Método getter para obtener el ID del PE
 int PE::getId() const {
     return id;
@@ -334,17 +730,30 @@ uint8_t PE::getQoS() const {
     return qos;
 }
 
-int PE::getCycleCounter() const {
+uint64_t PE::getCycleCounter() const {
     return cycleCounter;
 }
 
-void PE::setCycleCounter(int newClock) {
-    {
-        std::lock_guard<std::mutex> lock(cycle);
-        cycleCounter = newClock;
-    }
+size_t PE::getInstructionPointer() const {
+    return instructionPointer;
 }
 
 bool PE::getComplete() const {
     return complete;
 }
+
+const MSHRFile& PE::getMSHRs() const {
+    return mshrs;
+}
+
+uint64_t PE::getStallCycles() const {
+    return stallCycles;
+}
+
+const PEStats& PE::getStats() const {
+    return stats;
+}
+
+const WriteCombiningBuffer& PE::getWriteCombining() const {
+    return writeCombining;
+}
@@ -0,0 +1,46 @@
+#include "RunControl.hpp"
+#include <iostream>
+
+void RunControl::configure(RunMode mode, const Breakpoints& bp, bool verbose) {
+    runMode = mode;
+    breakpoints = bp;
+    verboseOutput = verbose;
+}
+
+// Verifica si el paso actual cumple todas las condiciones de quiebre configuradas
+bool RunControl::matchesBreakpoint(int cycle, int pe, const char* msgType) const {
+    if (breakpoints.cycle >= 0 && breakpoints.cycle != cycle) return false;
+    if (breakpoints.pe >= 0 && breakpoints.pe != pe) return false;
+    if (!breakpoints.msgType.empty() && breakpoints.msgType != msgType) return false;
+    return true;
+}
+
+void RunControl::stepGate(int cycle, int pe, const char* msgType) {
+    if (runMode == RunMode::BATCH) return; // En modo batch no hay pausas ni locks
+
+    if (runMode == RunMode::STEP) {
+        if (!breakpointsEnabled.load(std::memory_order_relaxed) || !matchesBreakpoint(cycle, pe, msgType)) return;
+
+        std::lock_guard<std::mutex> lock(inputMutex);
+        {
+            std::lock_guard<std::mutex> outLock(outputMutex);
+            std::cout << "<< Breakpoint: ciclo " << cycle << ", PE " << pe << ", " << msgType
+                      << " (Enter para continuar, 'c' para ejecutar sin pausas) >>\n";
+        }
+        std::string input;
+        std::getline(std::cin, input);
+        if (input == "c") breakpointsEnabled = false;
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(inputMutex);
+    std::cin.get(); // Espera a que el usuario presione Enter
+}
+
+bool parseRunMode(const std::string& text, RunMode& mode) {
+    if (text == "interactive") mode = RunMode::INTERACTIVE;
+    else if (text == "batch") mode = RunMode::BATCH;
+    else if (text == "step") mode = RunMode::STEP;
+    else return false;
+    return true;
+}
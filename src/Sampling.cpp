@@ -0,0 +1,60 @@
+#include "Sampling.hpp"
+#include <cmath>
+
+std::string samplingConfigError(const SamplingConfig& config) {
+    if (!config.enabled()) return "";
+    if (config.window == 0) return "--sample-window debe ser mayor que 0.";
+    if (config.window > config.period) {
+        return "--sample-window no puede ser mayor que --sample-period (la ventana es parte del período).";
+    }
+    return "";
+}
+
+// Valor crítico de la t de Student para un intervalo bilateral del 95%
+static double studentT95(size_t degreesOfFreedom) {
+    static const double table[] = {12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+                                   2.201,  2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+                                   2.080,  2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042};
+    if (degreesOfFreedom == 0) return 0.0;
+    if (degreesOfFreedom <= sizeof(table) / sizeof(table[0])) return table[degreesOfFreedom - 1];
+    if (degreesOfFreedom <= 60) return 2.000;
+    if (degreesOfFreedom <= 120) return 1.980;
+    return 1.960;
+}
+
+void SampleSeries::add(double value) {
+    samples++;
+    double delta = value - average;
+    average += delta / double(samples);
+    squares += delta * (value - average);
+}
+
+size_t SampleSeries::count() const {
+    return samples;
+}
+
+double SampleSeries::mean() const {
+    return average;
+}
+
+double SampleSeries::halfWidth() const {
+    if (samples < 2) return 0.0;
+    double deviation = std::sqrt(squares / double(samples - 1));
+    return studentT95(samples - 1) * deviation / std::sqrt(double(samples));
+}
+
+bool SamplingResult::latencyEstimable() const {
+    return latency.count() > 0 && 2 * saturatedWindows <= windows;
+}
+
+uint64_t SamplingResult::totalInstructions() const {
+    return detailedInstructions + fastForwardInstructions;
+}
+
+double SamplingResult::estimatedCycles() const {
+    return cyclesPerInstruction.mean() * double(totalInstructions());
+}
+
+double SamplingResult::estimatedCyclesHalfWidth() const {
+    return cyclesPerInstruction.halfWidth() * double(totalInstructions());
+}
@@ -0,0 +1,78 @@
+#include "SharerDirectory.hpp"
+#include <algorithm>
+#include "Checkpoint.hpp"
+
+void SharerDirectory::setLineSize(uint32_t size) {
+    lineSize = size;
+    lines.clear();
+}
+
+void SharerDirectory::addSharer(uint32_t addr, uint16_t pe) {
+    auto& bits = lines[addr / lineSize];
+    if (bits.size() <= pe / 64u) bits.resize(pe / 64u + 1, 0);
+    bits[pe / 64] |= uint64_t(1) << (pe % 64);
+}
+
+void SharerDirectory::removeSharer(uint32_t addr, uint16_t pe) {
+    auto it = lines.find(addr / lineSize);
+    if (it == lines.end() || it->second.size() <= pe / 64u) return;
+    it->second[pe / 64] &= ~(uint64_t(1) << (pe % 64));
+}
+
+bool SharerDirectory::isSharer(uint32_t addr, uint16_t pe) const {
+    auto it = lines.find(addr / lineSize);
+    if (it == lines.end() || it->second.size() <= pe / 64u) return false;
+    return (it->second[pe / 64] >> (pe % 64)) & 1;
+}
+
+void SharerDirectory::sharers(uint32_t addr, std::vector<uint16_t>& out, int exclude) const {
+    out.clear();
+    auto it = lines.find(addr / lineSize);
+    if (it == lines.end()) return;
+
+    const auto& bits = it->second;
+    for (size_t word = 0; word < bits.size(); ++word) {
+        uint64_t remaining = bits[word];
+        while (remaining) {
+            int bit = __builtin_ctzll(remaining); // Recorre solo los bits encendidos
+            remaining &= remaining - 1;
+            int pe = int(word * 64 + bit);
+            if (pe != exclude) out.push_back(uint16_t(pe));
+        }
+    }
+}
+
+void SharerDirectory::invalidateOthers(uint32_t addr, int keeper) {
+    auto it = lines.find(addr / lineSize);
+    if (it == lines.end()) return;
+
+    // Se limpian los bits en su lugar: la entrada de la línea se reutiliza sin reservar memoria
+    bool keep = keeper >= 0 && isSharer(addr, uint16_t(keeper));
+    std::fill(it->second.begin(), it->second.end(), 0);
+    if (keep) it->second[keeper / 64] |= uint64_t(1) << (keeper % 64);
+}
+
+size_t SharerDirectory::trackedLines() const {
+    return lines.size();
+}
+
+void SharerDirectory::saveState(CheckpointWriter& out) const {
+    std::vector<uint32_t> order;
+    order.reserve(lines.size());
+    for (const auto& entry : lines) order.push_back(entry.first);
+    std::sort(order.begin(), order.end()); // El mismo estado da siempre el mismo archivo
+    out.put<uint64_t>(order.size());
+    for (uint32_t line : order) {
+        out.put(line);
+        out.putVector(lines.at(line));
+    }
+}
+
+void SharerDirectory::loadState(CheckpointReader& in) {
+    lines.clear();
+    uint64_t count = in.get<uint64_t>();
+    for (uint64_t i = 0; i < count && in.ok(); ++i) {
+        uint32_t line = in.get<uint32_t>();
+        in.getVector(lines[line]);
+    }
+}
@@ -0,0 +1,428 @@
+#include "Simulation.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+#include <sstream>
+
+bool parseSimulationOption(const std::string& arg, SimulationConfig& config, std::string& error) {
+    try {
+        if (arg.rfind("--run=", 0) == 0) {
+            if (!parseRunMode(arg.substr(6), config.runMode)) {
+                error = std::string("Modo de avance inválido: ") + arg.substr(6) + " (interactive|batch|step).";
+                return false;
+            }
+        } else if (arg.rfind("--break-cycle=", 0) == 0) {
+            config.breakpoints.cycle = std::stoi(arg.substr(14));
+        } else if (arg.rfind("--break-pe=", 0) == 0) {
+            config.breakpoints.pe = std::stoi(arg.substr(11));
+        } else if (arg.rfind("--break-msg=", 0) == 0) {
+            config.breakpoints.msgType = arg.substr(12);
+        } else if (arg == "--verbose") {
+            config.verbose = true;
+        } else if (arg.rfind("--pes=", 0) == 0) {
+            config.numPEs = std::stoi(arg.substr(6));
+            if (config.numPEs < 1 || config.numPEs > 0xFFFF) {
+                error = "La cantidad de PEs debe estar entre 1 y 65535.";
+                return false;
+            }
+        } else if (arg == "--coherence=broadcast") {
+            config.coherenceMode = CoherenceMode::BROADCAST;
+        } else if (arg == "--coherence=directory") {
+            config.coherenceMode = CoherenceMode::DIRECTORY;
+        } else if (arg.rfind("--protocol=", 0) == 0) {
+            if (!parseCoherenceProtocol(arg.substr(11), config.protocol)) {
+                error = std::string("Protocolo de coherencia inválido: ") + arg.substr(11) + " (none|mesi|moesi).";
+                return false;
+            }
+        } else if (arg.rfind("--cache-size=", 0) == 0) {
+            config.cacheConfig.sizeBytes = std::stoul(arg.substr(13));
+        } else if (arg.rfind("--assoc=", 0) == 0) {
+            config.cacheConfig.associativity = std::stoul(arg.substr(8));
+        } else if (arg.rfind("--line=", 0) == 0) {
+            config.cacheConfig.lineSize = std::stoul(arg.substr(7));
+        } else if (arg.rfind("--repl=", 0) == 0) {
+            if (!parseReplacementPolicy(arg.substr(7), config.cacheConfig.policy)) {
+                error = std::string("Política de reemplazo inválida: ") + arg.substr(7) + " (lru|plru|random).";
+                return false;
+            }
+        } else if (arg.rfind("--write-policy=", 0) == 0) {
+            if (!parseWritePolicy(arg.substr(15), config.cacheConfig.writePolicy)) {
+                error = std::string("Política de escritura inválida: ") + arg.substr(15) + " (through|back).";
+                return false;
+            }
+        } else if (arg.rfind("--wc-buffers=", 0) == 0) {
+            config.writeCombiningEntries = std::stoi(arg.substr(13));
+            if (config.writeCombiningEntries < 0) {
+                error = "La cantidad de entradas de write-combining no puede ser negativa.";
+                return false;
+            }
+        } else if (arg.rfind("--trace=", 0) == 0) {
+            if (!parseTraceFormat(arg.substr(8), config.traceFormat)) {
+                error = std::string("Formato de traza inválido: ") + arg.substr(8) + " (text|binary).";
+                return false;
+            }
+        } else if (arg.rfind("--mem-size=", 0) == 0) {
+            if (!parseByteSize(arg.substr(11), config.memoryConfig.sizeBytes)) {
+                error = std::string("Tamaño de memoria inválido: ") + arg.substr(11);
+                return false;
+            }
+        } else if (arg.rfind("--mem-file=", 0) == 0) {
+            config.memoryConfig.backingFile = arg.substr(11);
+        } else if (arg.rfind("--mem-image=", 0) == 0) {
+            config.memoryConfig.imageFile = arg.substr(12);
+        } else if (arg.rfind("--mem-banks=", 0) == 0) {
+            config.memoryConfig.banks = std::stoul(arg.substr(12));
+        } else if (arg.rfind("--mem-interleave=", 0) == 0) {
+            config.memoryConfig.interleaveBytes = std::stoul(arg.substr(17));
+        } else if (arg.rfind("--mem-latency=", 0) == 0) {
+            config.memoryConfig.bankLatency = std::stoull(arg.substr(14));
+        } else if (arg.rfind("--mem-occupancy=", 0) == 0) {
+            config.memoryConfig.bankOccupancy = std::stoull(arg.substr(16));
+        } else if (arg.rfind("--bus=", 0) == 0) {
+            if (!parseBusMode(arg.substr(6), config.busMode)) {
+                error = std::string("Modo de bus inválido: ") + arg.substr(6) + " (atomic|split).";
+                return false;
+            }
+        } else if (arg.rfind("--inflight=", 0) == 0) {
+            config.maxInFlight = std::stoi(arg.substr(11));
+            if (config.maxInFlight < 1) {
+                error = "La cantidad de transacciones en vuelo debe ser al menos 1.";
+                return false;
+            }
+        } else if (arg.rfind("--topology=", 0) == 0) {
+            if (!parseTopology(arg.substr(11), config.topologyConfig.type)) {
+                error = std::string("Topología inválida: ") + arg.substr(11) + " (bus|ring|mesh|crossbar).";
+                return false;
+            }
+        } else if (arg.rfind("--link-bw=", 0) == 0) {
+            config.topologyConfig.linkBytesPerCycle = std::stoul(arg.substr(10));
+            if (config.topologyConfig.linkBytesPerCycle < 1) {
+                error = "El ancho de banda de los enlaces debe ser al menos 1 byte por ciclo.";
+                return false;
+            }
+        } else if (arg.rfind("--hop-latency=", 0) == 0) {
+            config.topologyConfig.hopLatency = std::stoul(arg.substr(14));
+        } else if (arg.rfind("--instructions=", 0) == 0) {
+            config.workload.instructions = std::stoull(arg.substr(15));
+        } else if (arg.rfind("--seed=", 0) == 0) {
+            config.workload.seed = std::stoull(arg.substr(7));
+        } else if (arg.rfind("--read-percent=", 0) == 0) {
+            config.workload.readPercent = std::stoul(arg.substr(15));
+            if (config.workload.readPercent > 100) {
+                error = "El porcentaje de lecturas debe estar entre 0 y 100.";
+                return false;
+            }
+        } else if (arg.rfind("--write-bytes=", 0) == 0) {
+            config.workload.writeBytes = std::stoul(arg.substr(14));
+            if (config.workload.writeBytes % 4 != 0) {
+                error = "El tamaño de las escrituras debe ser múltiplo de 4 bytes.";
+                return false;
+            }
+        } else if (arg.rfind("--mshrs=", 0) == 0) {
+            config.mshrCount = std::stoi(arg.substr(8));
+            if (config.mshrCount < 0) {
+                error = "La cantidad de MSHRs no puede ser negativa.";
+                return false;
+            }
+        } else if (arg.rfind("--checkpoint=", 0) == 0) {
+            config.checkpointPath = arg.substr(13);
+        } else if (arg.rfind("--checkpoint-at=", 0) == 0) {
+            config.checkpointCycle = std::stoull(arg.substr(16));
+        } else if (arg == "--checkpoint-exit") {
+            config.checkpointExit = true;
+        } else if (arg.rfind("--restore=", 0) == 0) {
+            config.restorePath = arg.substr(10);
+        } else if (arg.rfind("--sample-period=", 0) == 0) {
+            config.sampling.period = std::stoull(arg.substr(16));
+        } else if (arg.rfind("--sample-window=", 0) == 0) {
+            config.sampling.window = std::stoull(arg.substr(16));
+        } else if (arg.rfind("--sample-warmup=", 0) == 0) {
+            config.sampling.warmup = std::stoull(arg.substr(16));
+        } else if (arg.rfind("--workers=", 0) == 0) {
+            config.workerThreads = std::stoi(arg.substr(10));
+            if (config.workerThreads < 1) {
+                error = "La cantidad de hilos debe ser al menos 1.";
+                return false;
+            }
+        } else {
+            error = std::string("Opción desconocida: ") + arg;
+            return false;
+        }
+    } catch (...) {
+        error = std::string("Valor numérico inválido en la opción ") + arg;
+        return false;
+    }
+    return true;
+}
+
+std::string simulationConfigError(const SimulationConfig& config) {
+    std::string cacheError = cacheConfigError(config.cacheConfig);
+    if (!cacheError.empty()) return cacheError;
+    if (config.protocol != CoherenceProtocol::NONE &&
+        (config.cacheConfig.writePolicy == WritePolicy::WRITE_BACK || config.writeCombiningEntries > 0)) {
+        return "--write-policy=back y --wc-buffers solo aplican con --protocol=none (los protocolos ya son write-back).";
+    }
+    if (config.cacheConfig.writePolicy == WritePolicy::WRITE_BACK && config.writeCombiningEntries > 0) {
+        return "--wc-buffers combina escrituras write-through; con --write-policy=back no aplica.";
+    }
+    if (!config.checkpointPath.empty() && config.checkpointCycle == 0) {
+        return "--checkpoint requiere el ciclo en el que se guarda (--checkpoint-at=N, N > 0).";
+    }
+    if (config.checkpointPath.empty() && (config.checkpointCycle > 0 || config.checkpointExit)) {
+        return "--checkpoint-at y --checkpoint-exit requieren --checkpoint=RUTA.";
+    }
+    std::string samplingError = samplingConfigError(config.sampling);
+    if (!samplingError.empty()) return samplingError;
+    if (config.sampling.enabled() && (!config.checkpointPath.empty() || !config.restorePath.empty())) {
+        return "--checkpoint y --restore no aplican a una simulación muestreada (--sample-period).";
+    }
+    return memoryConfigError(config.memoryConfig);
+}
+
+std::string checkpointKey(const SimulationConfig& config) {
+    const CacheConfig& cache = config.cacheConfig;
+    const MemoryConfig& memory = config.memoryConfig;
+    std::string workload = "test" + std::to_string(config.testNumber);
+    if (config.synthetic) {
+        workload = std::string(trafficPatternName(config.workload.pattern)) + ":" +
+                   std::to_string(config.workload.instructions) + ":" + std::to_string(config.workload.seed) + ":" +
+                   std::to_string(config.workload.readPercent) + ":" + std::to_string(config.workload.writeBytes);
+    }
+    return "workload=" + workload + " pes=" + std::to_string(config.numPEs) +
+           " arbiter=" + std::to_string(config.arbiterMode) +
+           " cache=" + std::to_string(cache.sizeBytes) + "x" + std::to_string(cache.associativity) + "x" +
+           std::to_string(cache.lineSize) + " repl=" + std::to_string(int(cache.policy)) +
+           " write-policy=" + std::to_string(int(cache.writePolicy)) +
+           " protocol=" + coherenceProtocolName(config.protocol) +
+           " coherence=" + std::to_string(int(config.coherenceMode)) +
+           " bus=" + std::to_string(int(config.busMode)) +
+           " topology=" + topologyName(config.topologyConfig.type) +
+           " mem-size=" + std::to_string(memory.sizeBytes) + " mem-banks=" + std::to_string(memory.banks) +
+           " mem-interleave=" + std::to_string(memory.interleaveBytes) +
+           " mshrs=" + std::to_string(config.mshrCount) + " wc-buffers=" + std::to_string(config.writeCombiningEntries);
+}
+
+// Trunca intconnect y peN (.txt o .bin) con su encabezado; los registros se escriben en un hilo de fondo
+Simulation::Simulation(const SimulationConfig& simulationConfig)
+    : config(simulationConfig),
+      traceWriter(config.outputDir, size_t(config.numPEs), config.traceFormat),
+      simulator(config.workerThreads),
+      interconnect(&simulator, config.arbiterMode) {}
+
+bool Simulation::prepare() {
+    if (!traceWriter.ok()) {
+        std::cerr << "Error al intentar limpiar el archivo: " << traceWriter.failedPath() << "\n";
+    }
+
+    // En modo batch la consola queda en silencio salvo que se pida --verbose
+    simulator.getRunControl().configure(config.runMode, config.breakpoints,
+                                        config.runMode != RunMode::BATCH || config.verbose);
+    simulator.setTraceWriter(&traceWriter);
+    interconnect.setCoherenceMode(config.coherenceMode);
+    interconnect.setCoherenceProtocol(config.protocol);
+    interconnect.setLineSize(uint32_t(config.cacheConfig.lineSize));
+    interconnect.setBusMode(config.busMode, size_t(config.maxInFlight));
+    if (!interconnect.getMainMemory().configure(config.memoryConfig)) return false;
+
+    // Programa de cada PE: el PE i usa programs[i mod cantidad]
+    std::vector<std::shared_ptr<const InstructionStream>> programs;
+    if (config.synthetic) {
+        // Se generan directamente en memoria, uno por PE
+        WorkloadConfig workload = config.workload;
+        workload.memorySize = config.memoryConfig.sizeBytes;
+        workload.lineSize = uint32_t(config.cacheConfig.lineSize);
+        for (int i = 0; i < config.numPEs; i++) {
+            programs.push_back(std::make_shared<InstructionStream>(generateWorkload(workload, uint16_t(i), uint16_t(config.numPEs))));
+        }
+    } else {
+        // Cantidad de workloads disponibles en el test: si hay más PEs que archivos, se reutilizan en ciclo
+        std::string path = instructionPath();
+        int numWorkloads = 0;
+        while (std::filesystem::exists(path + "/workload_" + std::to_string(numWorkloads) + ".txt")) numWorkloads++;
+        if (numWorkloads == 0) {
+            std::cerr << "Error: No se encontraron workloads en " << path << "\n";
+            return false;
+        }
+
+        // Cada workload se decodifica una sola vez; los PEs que lo reutilizan comparten el programa
+        for (int w = 0; w < numWorkloads; w++) {
+            auto program = std::make_shared<InstructionStream>();
+            std::string workloadPath = path + "/workload_" + std::to_string(w) + ".txt";
+            if (!program->load(workloadPath)) {
+                std::cerr << "Error: No se pudo leer " << workloadPath << "\n";
+                return false;
+            }
+            programs.push_back(std::move(program));
+        }
+    }
+
+    for (int i = 0; i < config.numPEs; i++) {
+        auto pe = std::make_unique<PE>(i, uint8_t(std::min(i, 0xFF)), &interconnect, &simulator, config.cacheConfig);
+        interconnect.registerPE(i, pe.get());
+        pe->setMSHRs(size_t(config.mshrCount));
+        pe->setWriteCombining(size_t(config.writeCombiningEntries));
+        pe->setProgram(programs[i % programs.size()]);
+        pes.push_back(std::move(pe));
+    }
+
+    interconnect.setTopology(config.topologyConfig); // Un nodo por PE más el controlador de memoria
+    if (!config.restorePath.empty()) return loadCheckpoint(config.restorePath);
+    return true;
+}
+
+bool Simulation::run() {
+    if (config.sampling.enabled()) {
+        runSampled();
+        return true;
+    }
+    if (!restored) {
+        for (auto& pe : pes) pe->start();
+    }
+    if (!config.checkpointPath.empty()) {
+        simulator.runUntil(config.checkpointCycle);
+        if (!saveCheckpoint(config.checkpointPath)) return false;
+        if (config.checkpointExit) return true;
+    }
+    simulator.run();
+    return true;
+}
+
+// Cada período: avance rápido de period - window instrucciones por PE (intercaladas de a una entre
+// los PEs, como se emitirían en paralelo) y una ventana detallada de window instrucciones que corre
+// hasta drenar el interconnect. El tiempo del kernel solo avanza en las ventanas. Los ciclos por
+// instrucción de cada ventana cubren hasta el drenaje: si los PEs emiten más rápido de lo que el
+// interconnect atiende (sin límite de MSHRs, o escrituras write-through), el trabajo pendiente es
+// parte del costo de la ventana. La latencia se mide desde warmup ciclos después del comienzo hasta
+// que el primer PE termina la ventana, mientras hay tantas solicitudes en vuelo como en la ejecución
+// completa.
+void Simulation::runSampled() {
+    struct Totals {
+        uint64_t issued = 0, requests = 0, latency = 0;
+    };
+    auto totals = [&]() {
+        Totals sum;
+        for (const auto& pe : pes) {
+            const LatencyHistogram& histogram = interconnect.getLatency(uint16_t(pe->getId()));
+            sum.issued += pe->getInstructionPointer();
+            sum.requests += histogram.count();
+            sum.latency += histogram.sum();
+        }
+        return sum;
+    };
+
+    sampling = SamplingResult();
+    uint64_t fastForward = config.sampling.period - config.sampling.window;
+    for (;;) {
+        for (uint64_t i = 0; i < fastForward; ++i) {
+            bool active = false;
+            for (auto& pe : pes) {
+                if (pe->fastForward()) {
+                    active = true;
+                    sampling.fastForwardInstructions++;
+                }
+            }
+            if (!active) break;
+        }
+
+        uint64_t start = simulator.now();
+        uint64_t measureFrom = start + config.sampling.warmup; // Las colas arrancan vacías en cada ventana
+        Totals before = totals();
+        simulator.setMeasurement(measureFrom, UINT64_MAX);
+        bool active = false;
+        for (auto& pe : pes) {
+            if (pe->runDetailed(size_t(config.sampling.window))) active = true;
+        }
+        if (!active) break;
+        simulator.run();
+
+        Totals after = totals();
+        uint64_t issued = after.issued - before.issued;
+        uint64_t issueEnd = std::min(simulator.getMeasurementEnd(), simulator.now()); // El primer PE terminó
+        sampling.windows++;
+        sampling.detailedInstructions += issued;
+        sampling.detailedCycles += simulator.now() - start;
+        if (issued > 0) sampling.cyclesPerInstruction.add(double(simulator.now() - start) / double(issued));
+        if (simulator.now() - issueEnd > issueEnd - start) sampling.saturatedWindows++;
+        if (after.requests > before.requests) {
+            sampling.latency.add(double(after.latency - before.latency) / double(after.requests - before.requests));
+        }
+    }
+    simulator.setMeasurement(0, UINT64_MAX);
+}
+
+std::vector<SimObject*> Simulation::eventTargets() {
+    std::vector<SimObject*> targets;
+    targets.reserve(pes.size() + 1);
+    targets.push_back(&interconnect);
+    for (const auto& pe : pes) targets.push_back(pe.get());
+    return targets;
+}
+
+// Orden del archivo: clave de configuración, kernel, interconnect (con la memoria) y cada PE por ID
+bool Simulation::saveCheckpoint(const std::string& path) {
+    CheckpointWriter out;
+    out.putString(checkpointKey(config));
+    simulator.saveState(out, eventTargets());
+    interconnect.saveState(out);
+    for (const auto& pe : pes) pe->saveState(out);
+    return out.save(path);
+}
+
+bool Simulation::loadCheckpoint(const std::string& path) {
+    CheckpointReader in;
+    if (!in.load(path)) return false;
+
+    std::string key;
+    in.getString(key);
+    std::string expected = checkpointKey(config);
+    if (key != expected) {
+        // Informa el primer parámetro distinto
+        std::istringstream saved(key), current(expected);
+        std::string savedItem, currentItem;
+        while (saved >> savedItem && current >> currentItem && savedItem == currentItem) {}
+        std::cerr << "Error: El checkpoint " << path << " es de otra configuración (" << savedItem
+                  << "; ahora " << currentItem << ").\n";
+        return false;
+    }
+
+    simulator.loadState(in, eventTargets());
+    interconnect.loadState(in);
+    for (const auto& pe : pes) {
+        if (!in.ok()) break;
+        pe->loadState(in);
+    }
+    if (!in.ok() || !in.atEnd()) {
+        std::cerr << "Error: El checkpoint " << path << " está incompleto o dañado.\n";
+        return false;
+    }
+    restored = true;
+    return true;
+}
+
+std::string Simulation::instructionPath() const {
+    return config.workloadsDir + "/test" + std::to_string(config.testNumber);
+}
+
+const SimulationConfig& Simulation::getConfig() const {
+    return config;
+}
+
+const SamplingResult& Simulation::getSampling() const {
+    return sampling;
+}
+
+Simulator& Simulation::getSimulator() {
+    return simulator;
+}
+
+Interconnect& Simulation::getInterconnect() {
+    return interconnect;
+}
+
+TraceWriter& Simulation::getTraceWriter() {
+    return traceWriter;
+}
+
+const std::vector<std::unique_ptr<PE>>& Simulation::getPEs() const {
+    return pes;
+}
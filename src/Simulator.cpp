@@ -0,0 +1,154 @@
+#include "Simulator.hpp"
+#include <algorithm>
+#include <unordered_map>
+#include "Checkpoint.hpp"
+
+Simulator::Simulator(size_t workerThreads)
+    : workerPool(std::max<size_t>(workerThreads, 1))
+{}
+
+// Agenda un evento; si se pide un ciclo anterior al actual se agenda en el ciclo actual
+void Simulator::schedule(uint64_t time, EventType type, SimObject* target) {
+    events.push(Event{std::max(time, currentTime), type, nextSeq++, target});
+}
+
+// Los eventos propios de un PE (emisión y entrega de respuestas) solo modifican el estado de ese PE
+static bool isPerPEEvent(EventType type) {
+    return type == EventType::PE_ISSUE || type == EventType::RESPONSE_DELIVERY;
+}
+
+void Simulator::run() {
+    runUntil(UINT64_MAX);
+}
+
+// Bucle principal del kernel: toma siempre el evento más temprano y lo despacha a su componente.
+// Se detiene antes del primer evento del ciclo indicado, con todos los ciclos anteriores completos.
+void Simulator::runUntil(uint64_t cycle) {
+    while (!events.empty() && events.top().time < cycle) {
+        Event event = events.top();
+        events.pop();
+        currentTime = event.time;
+
+        if (!isPerPEEvent(event.type)) {
+            processedEvents++;
+            event.target->handleEvent(event.type, currentTime);
+            event.target->commitEvent(event.type, currentTime);
+            continue;
+        }
+
+        // Agrupa todos los eventos del mismo tipo y ciclo (quedan contiguos por el orden de la cola).
+        // Un mismo PE puede tener varias entregas en el ciclo: se procesan juntas en una sola llamada.
+        uint64_t batch = ++batchCounter;
+        issueBatch.clear();
+        issueBatch.push_back(event.target);
+        event.target->batchMark = batch;
+        while (!events.empty() && events.top().time == currentTime && events.top().type == event.type) {
+            SimObject* target = events.top().target;
+            if (target->batchMark != batch) {
+                target->batchMark = batch;
+                issueBatch.push_back(target);
+            }
+            events.pop();
+            processedEvents++;
+        }
+        processedEvents++;
+
+        // Fase paralela: cada PE lógico procesa su evento en algún hilo del grupo
+        uint64_t now = currentTime;
+        EventType type = event.type;
+        workerPool.runBatch(issueBatch.size(), [this, now, type](size_t i) {
+            issueBatch[i]->handleEvent(type, now);
+        });
+
+        // Fase secuencial: en orden de agenda, para que el resultado no dependa de la cantidad de hilos
+        for (SimObject* target : issueBatch) target->commitEvent(type, now);
+    }
+}
+
+bool Simulator::pending() const {
+    return !events.empty();
+}
+
+uint64_t Simulator::now() const {
+    return currentTime;
+}
+
+void Simulator::setMeasurement(uint64_t from, uint64_t until) {
+    measureFrom = from;
+    measureUntil = until;
+}
+
+void Simulator::closeMeasurement(uint64_t cycle) {
+    measureUntil = std::min(measureUntil, cycle);
+}
+
+uint64_t Simulator::getMeasurementEnd() const {
+    return measureUntil;
+}
+
+uint64_t Simulator::getProcessedEvents() const {
+    return processedEvents;
+}
+
+size_t Simulator::getWorkerThreads() const {
+    return workerPool.size();
+}
+
+void Simulator::setTraceWriter(TraceWriter* writer) {
+    traceWriter = writer;
+}
+
+TraceWriter* Simulator::getTraceWriter() const {
+    return traceWriter;
+}
+
+RunControl& Simulator::getRunControl() {
+    return runControl;
+}
+
+const RunControl& Simulator::getRunControl() const {
+    return runControl;
+}
+
+void Simulator::saveState(CheckpointWriter& out, const std::vector<SimObject*>& objects) const {
+    out.put(currentTime);
+    out.put(nextSeq);
+    out.put(processedEvents);
+
+    std::unordered_map<const SimObject*, uint32_t> index;
+    for (size_t i = 0; i < objects.size(); ++i) index[objects[i]] = uint32_t(i);
+
+    // La cola se recorre sobre una copia, en orden de proceso
+    auto queue = events;
+    out.put<uint64_t>(queue.size());
+    for (; !queue.empty(); queue.pop()) {
+        const Event& event = queue.top();
+        out.put(event.time);
+        out.put(uint8_t(event.type));
+        out.put(event.seq);
+        out.put(index.at(event.target));
+    }
+}
+
+void Simulator::loadState(CheckpointReader& in, const std::vector<SimObject*>& objects) {
+    in.get(currentTime);
+    in.get(nextSeq);
+    in.get(processedEvents);
+
+    events = {};
+    uint64_t count = in.get<uint64_t>();
+    for (uint64_t i = 0; i < count && in.ok(); ++i) {
+        Event event;
+        in.get(event.time);
+        uint8_t type = in.get<uint8_t>();
+        in.get(event.seq);
+        uint32_t target = in.get<uint32_t>();
+        if (type > uint8_t(EventType::INTERCONNECT_SERVICE) || target >= objects.size()) {
+            in.fail();
+            return;
+        }
+        event.type = EventType(type);
+        event.target = objects[target];
+        events.push(event);
+    }
+}
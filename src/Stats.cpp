@@ -0,0 +1,196 @@
+#include "Stats.hpp"
+#include <fstream>
+#include <iostream>
+#include "Interconnect.hpp"
+#include "PE.hpp"
+#include "Simulator.hpp"
+
+namespace {
+
+bool endsWith(const std::string& text, const std::string& suffix) {
+    return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+double hitRate(const PEStats& stats) {
+    uint64_t reads = stats.readHits + stats.readMisses;
+    return reads ? double(stats.readHits) / double(reads) : 0.0;
+}
+
+// Latencia total: unión de los histogramas por PE
+LatencyHistogram mergedLatency(const Interconnect& interconnect, const std::vector<std::unique_ptr<PE>>& pes) {
+    LatencyHistogram all;
+    for (const auto& pe : pes) all.merge(interconnect.getLatency(uint16_t(pe->getId())));
+    return all;
+}
+
+// -------------------- JSON --------------------
+
+void jsonMessages(std::ostream& out, const MessageCounters& counters) {
+    out << "{";
+    for (size_t type = 0; type < MESSAGE_TYPE_COUNT; ++type) {
+        out << (type ? ", " : "") << "\"" << messageTypeName(MessageType(type)) << "\": {\"count\": "
+            << counters.count[type] << ", \"bytes\": " << counters.bytes[type] << "}";
+    }
+    out << "}";
+}
+
+// Resumen y buckets no vacíos como [desde, hasta, muestras]
+void jsonHistogram(std::ostream& out, const LatencyHistogram& histogram) {
+    out << "{\"count\": " << histogram.count() << ", \"mean\": " << histogram.mean()
+        << ", \"p50\": " << histogram.percentile(50) << ", \"p95\": " << histogram.percentile(95)
+        << ", \"p99\": " << histogram.percentile(99) << ", \"max\": " << histogram.max() << ", \"buckets\": [";
+    bool first = true;
+    histogram.forEachBucket([&](uint64_t low, uint64_t high, uint64_t samples) {
+        out << (first ? "" : ", ") << "[" << low << ", " << high << ", " << samples << "]";
+        first = false;
+    });
+    out << "]}";
+}
+
+void writeJson(std::ostream& out, const Simulator& simulator, const Interconnect& interconnect,
+               const std::vector<std::unique_ptr<PE>>& pes) {
+    const InterconnectStats& stats = interconnect.getStats();
+    out << "{\n"
+        << "  \"cycles\": " << simulator.now() << ",\n"
+        << "  \"events\": " << simulator.getProcessedEvents() << ",\n"
+        << "  \"interconnect\": {\n"
+        << "    \"bus_busy_cycles\": " << interconnect.getBusBusyCycles() << ",\n"
+        << "    \"completed_transactions\": " << interconnect.getCompletedTransactions() << ",\n"
+        << "    \"peak_in_flight\": " << interconnect.getPeakInFlight() << ",\n"
+        << "    \"invalidations_sent\": " << interconnect.getInvalidationsSent() << ",\n"
+        << "    \"invalidations_avoided\": " << interconnect.getInvalidationsAvoided() << ",\n"
+        << "    \"memory_reads\": " << stats.memoryReads << ",\n"
+        << "    \"memory_writes\": " << stats.memoryWrites << ",\n"
+        << "    \"cache_to_cache_transfers\": " << stats.cacheToCacheTransfers << ",\n"
+        << "    \"writebacks\": " << stats.writebacks << ",\n"
+        << "    \"recalled_lines\": " << stats.recalledLines << ",\n"
+        << "    \"traffic_bytes\": " << stats.trafficBytes() << ",\n"
+        << "    \"messages_received\": ";
+    jsonMessages(out, stats.received);
+    out << ",\n    \"messages_sent\": ";
+    jsonMessages(out, stats.sent);
+    out << ",\n    \"queue_occupancy\": ";
+    jsonHistogram(out, stats.queueOccupancy);
+    out << ",\n    \"latency\": ";
+    jsonHistogram(out, mergedLatency(interconnect, pes));
+    out << "\n  },\n  \"pes\": [";
+
+    for (size_t i = 0; i < pes.size(); ++i) {
+        const PE& pe = *pes[i];
+        const PEStats& peStats = pe.getStats();
+        out << (i ? "," : "") << "\n    {\"id\": " << pe.getId()
+            << ", \"cycles\": " << pe.getCycleCounter()
+            << ", \"cache_hits\": " << peStats.readHits
+            << ", \"cache_misses\": " << peStats.readMisses
+            << ", \"hit_rate\": " << hitRate(peStats)
+            << ", \"writes\": " << peStats.writes
+            << ", \"write_hits\": " << peStats.writeHits
+            << ", \"writebacks\": " << peStats.writebacks
+            << ", \"invalidation_flushes\": " << peStats.invalidationFlushes
+            << ", \"wc_combined\": " << pe.getWriteCombining().getCombinedWrites()
+            << ", \"wc_full_lines\": " << pe.getWriteCombining().getFullLines()
+            << ", \"invalidations_received\": " << peStats.invalidationsReceived
+            << ", \"invalidations_useful\": " << peStats.invalidationsUseful
+            << ", \"mshr_merged\": " << pe.getMSHRs().getSecondaryMisses()
+            << ", \"stall_cycles\": " << pe.getStallCycles()
+            << ",\n     \"messages_sent\": ";
+        jsonMessages(out, peStats.sent);
+        out << ",\n     \"messages_received\": ";
+        jsonMessages(out, peStats.received);
+        out << ",\n     \"latency\": ";
+        jsonHistogram(out, interconnect.getLatency(uint16_t(pe.getId())));
+        out << "}";
+    }
+    out << "\n  ]\n}\n";
+}
+
+// -------------------- CSV --------------------
+
+// Formato largo: una fila "ámbito,id,métrica,valor" por contador
+template <typename Value>
+void csvRow(std::ostream& out, const char* scope, const std::string& id, const std::string& metric, Value value) {
+    out << scope << "," << id << "," << metric << "," << value << "\n";
+}
+
+void csvMessages(std::ostream& out, const char* scope, const std::string& id, const std::string& prefix,
+                 const MessageCounters& counters) {
+    for (size_t type = 0; type < MESSAGE_TYPE_COUNT; ++type) {
+        std::string name = prefix + "." + messageTypeName(MessageType(type));
+        csvRow(out, scope, id, name + ".count", counters.count[type]);
+        csvRow(out, scope, id, name + ".bytes", counters.bytes[type]);
+    }
+}
+
+void csvHistogram(std::ostream& out, const char* scope, const std::string& id, const std::string& prefix,
+                  const LatencyHistogram& histogram) {
+    csvRow(out, scope, id, prefix + ".count", histogram.count());
+    csvRow(out, scope, id, prefix + ".mean", histogram.mean());
+    csvRow(out, scope, id, prefix + ".p50", histogram.percentile(50));
+    csvRow(out, scope, id, prefix + ".p95", histogram.percentile(95));
+    csvRow(out, scope, id, prefix + ".p99", histogram.percentile(99));
+    csvRow(out, scope, id, prefix + ".max", histogram.max());
+    histogram.forEachBucket([&](uint64_t low, uint64_t high, uint64_t samples) {
+        csvRow(out, scope, id, prefix + ".bucket." + std::to_string(low) + "-" + std::to_string(high), samples);
+    });
+}
+
+void writeCsv(std::ostream& out, const Simulator& simulator, const Interconnect& interconnect,
+              const std::vector<std::unique_ptr<PE>>& pes) {
+    const InterconnectStats& stats = interconnect.getStats();
+    out << "scope,id,metric,value\n";
+    csvRow(out, "simulation", "", "cycles", simulator.now());
+    csvRow(out, "simulation", "", "events", simulator.getProcessedEvents());
+
+    const char* ic = "interconnect";
+    csvRow(out, ic, "", "bus_busy_cycles", interconnect.getBusBusyCycles());
+    csvRow(out, ic, "", "completed_transactions", interconnect.getCompletedTransactions());
+    csvRow(out, ic, "", "peak_in_flight", interconnect.getPeakInFlight());
+    csvRow(out, ic, "", "invalidations_sent", interconnect.getInvalidationsSent());
+    csvRow(out, ic, "", "invalidations_avoided", interconnect.getInvalidationsAvoided());
+    csvRow(out, ic, "", "memory_reads", stats.memoryReads);
+    csvRow(out, ic, "", "memory_writes", stats.memoryWrites);
+    csvRow(out, ic, "", "cache_to_cache_transfers", stats.cacheToCacheTransfers);
+    csvRow(out, ic, "", "writebacks", stats.writebacks);
+    csvRow(out, ic, "", "recalled_lines", stats.recalledLines);
+    csvRow(out, ic, "", "traffic_bytes", stats.trafficBytes());
+    csvMessages(out, ic, "", "messages_received", stats.received);
+    csvMessages(out, ic, "", "messages_sent", stats.sent);
+    csvHistogram(out, ic, "", "queue_occupancy", stats.queueOccupancy);
+    csvHistogram(out, ic, "", "latency", mergedLatency(interconnect, pes));
+
+    for (const auto& pe : pes) {
+        const PEStats& peStats = pe->getStats();
+        std::string id = std::to_string(pe->getId());
+        csvRow(out, "pe", id, "cycles", pe->getCycleCounter());
+        csvRow(out, "pe", id, "cache_hits", peStats.readHits);
+        csvRow(out, "pe", id, "cache_misses", peStats.readMisses);
+        csvRow(out, "pe", id, "hit_rate", hitRate(peStats));
+        csvRow(out, "pe", id, "writes", peStats.writes);
+        csvRow(out, "pe", id, "write_hits", peStats.writeHits);
+        csvRow(out, "pe", id, "writebacks", peStats.writebacks);
+        csvRow(out, "pe", id, "invalidation_flushes", peStats.invalidationFlushes);
+        csvRow(out, "pe", id, "wc_combined", pe->getWriteCombining().getCombinedWrites());
+        csvRow(out, "pe", id, "wc_full_lines", pe->getWriteCombining().getFullLines());
+        csvRow(out, "pe", id, "invalidations_received", peStats.invalidationsReceived);
+        csvRow(out, "pe", id, "invalidations_useful", peStats.invalidationsUseful);
+        csvRow(out, "pe", id, "mshr_merged", pe->getMSHRs().getSecondaryMisses());
+        csvRow(out, "pe", id, "stall_cycles", pe->getStallCycles());
+        csvMessages(out, "pe", id, "messages_sent", peStats.sent);
+        csvMessages(out, "pe", id, "messages_received", peStats.received);
+        csvHistogram(out, "pe", id, "latency", interconnect.getLatency(uint16_t(pe->getId())));
+    }
+}
+
+} // namespace
+
+bool writeStats(const std::string& path, const Simulator& simulator, const Interconnect& interconnect,
+                const std::vector<std::unique_ptr<PE>>& pes) {
+    std::ofstream out(path);
+    if (!out) {
+        std::cerr << "ERROR: No se pudo escribir el archivo de estadísticas " << path << "\n";
+        return false;
+    }
+    if (endsWith(path, ".csv")) writeCsv(out, simulator, interconnect, pes);
+    else writeJson(out, simulator, interconnect, pes);
+    return bool(out);
+}
@@ -0,0 +1,223 @@
+#include "Topology.hpp"
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include "Checkpoint.hpp"
+
+bool parseTopology(const std::string& text, TopologyType& type) {
+    if (text == "bus") type = TopologyType::BUS;
+    else if (text == "ring") type = TopologyType::RING;
+    else if (text == "mesh") type = TopologyType::MESH;
+    else if (text == "crossbar") type = TopologyType::CROSSBAR;
+    else return false;
+    return true;
+}
+
+const char* topologyName(TopologyType type) {
+    switch (type) {
+        case TopologyType::BUS:      return "bus";
+        case TopologyType::RING:     return "ring";
+        case TopologyType::MESH:     return "mesh";
+        case TopologyType::CROSSBAR: return "crossbar";
+    }
+    return "?";
+}
+
+Topology::Topology(const TopologyConfig& config, size_t numNodes, size_t routerLinks)
+    : config(config),
+      numNodes(numNodes),
+      reservations(2 * numNodes + routerLinks),
+      busyCycles(2 * numNodes + routerLinks, 0)
+{
+    if (this->config.linkBytesPerCycle == 0) this->config.linkBytesPerCycle = 1;
+}
+
+uint64_t Topology::transfer(uint16_t src, uint16_t dst, uint32_t bytes, uint64_t start) {
+    uint64_t serialization = (bytes + config.linkBytesPerCycle - 1) / config.linkBytesPerCycle;
+    if (serialization == 0) serialization = 1;
+
+    path.clear();
+    path.push_back(uint32_t(injectLink(src)));
+    route(src, dst, path);
+    path.push_back(uint32_t(ejectLink(dst)));
+
+    // La cabeza avanza un enlace cada hopLatency ciclos; si el enlace está ocupado espera a que se libere
+    uint64_t head = start;
+    uint64_t lastStart = start;
+    for (uint32_t link : path) {
+        lastStart = reserve(link, head, serialization);
+        busyCycles[link] += serialization;
+        head = lastStart + config.hopLatency;
+    }
+
+    transfers++;
+    totalHops += path.size();
+    return lastStart + serialization;
+}
+
+void Topology::advance(uint64_t now) {
+    currentCycle = std::max(currentCycle, now);
+}
+
+uint64_t Topology::reserve(size_t link, uint64_t earliest, uint64_t cycles) {
+    std::vector<Reservation>& booked = reservations[link];
+
+    // Las reservas ya terminadas no pueden volver a estorbar (las transferencias nunca empiezan en el pasado)
+    auto live = std::partition_point(booked.begin(), booked.end(),
+                                     [this](const Reservation& r) { return r.end <= currentCycle; });
+    booked.erase(booked.begin(), live);
+
+    // Los intervalos están ordenados también por fin: la búsqueda empieza en el primero que termina después de earliest
+    uint64_t start = earliest;
+    auto it = std::partition_point(booked.begin(), booked.end(),
+                                   [start](const Reservation& r) { return r.end <= start; });
+    for (; it != booked.end(); ++it) {
+        if (it->start >= start + cycles) break; // Entra en el hueco anterior a esta reserva
+        start = it->end;
+    }
+
+    // Un enlace saturado queda como pocos intervalos largos: la nueva reserva se une a las que toca
+    uint64_t end = start + cycles;
+    bool joinsPrevious = it != booked.begin() && std::prev(it)->end == start;
+    bool joinsNext = it != booked.end() && it->start == end;
+    if (joinsPrevious && joinsNext) {
+        std::prev(it)->end = it->end;
+        booked.erase(it);
+    } else if (joinsPrevious) {
+        std::prev(it)->end = end;
+    } else if (joinsNext) {
+        it->start = start;
+    } else {
+        booked.insert(it, Reservation{start, end});
+    }
+    return start;
+}
+
+size_t Topology::getNumNodes() const {
+    return numNodes;
+}
+
+size_t Topology::getNumLinks() const {
+    return reservations.size();
+}
+
+uint64_t Topology::getLinkBusyCycles(size_t link) const {
+    return busyCycles[link];
+}
+
+size_t Topology::ejectLink(uint16_t node) const {
+    return numNodes + node;
+}
+
+uint64_t Topology::getTransfers() const {
+    return transfers;
+}
+
+uint64_t Topology::getTotalHops() const {
+    return totalHops;
+}
+
+void Topology::saveState(CheckpointWriter& out) const {
+    out.put<uint64_t>(reservations.size());
+    for (const auto& booked : reservations) out.putVector(booked);
+    out.putVector(busyCycles);
+    out.put(currentCycle);
+    out.put(transfers);
+    out.put(totalHops);
+}
+
+void Topology::loadState(CheckpointReader& in) {
+    if (in.get<uint64_t>() != reservations.size()) in.fail();
+    for (auto& booked : reservations) {
+        if (!in.ok()) return;
+        in.getVector(booked);
+    }
+    size_t links = busyCycles.size();
+    in.getVector(busyCycles);
+    if (busyCycles.size() != links) in.fail();
+    in.get(currentCycle);
+    in.get(transfers);
+    in.get(totalHops);
+}
+
+// -------------------- Anillo --------------------
+
+// Enlaces 0..N-1: sentido horario (i -> i+1); N..2N-1: antihorario (i -> i-1)
+RingTopology::RingTopology(const TopologyConfig& config, size_t numNodes)
+    : Topology(config, numNodes, 2 * numNodes) {}
+
+std::string RingTopology::describe() const {
+    return "ring de " + std::to_string(numNodes) + " nodos";
+}
+
+void RingTopology::route(uint16_t src, uint16_t dst, std::vector<uint32_t>& path) const {
+    size_t clockwise = (dst + numNodes - src) % numNodes;
+    size_t counter = numNodes - clockwise;
+    size_t node = src;
+    if (clockwise <= counter) {
+        for (size_t i = 0; i < clockwise; ++i) {
+            path.push_back(uint32_t(routerLink(node)));
+            node = (node + 1) % numNodes;
+        }
+    } else {
+        for (size_t i = 0; i < counter; ++i) {
+            path.push_back(uint32_t(routerLink(numNodes + node)));
+            node = (node + numNodes - 1) % numNodes;
+        }
+    }
+}
+
+// -------------------- Malla 2D --------------------
+
+// Ancho de la malla lo más cuadrada posible para numNodes nodos
+static size_t meshWidth(size_t numNodes) {
+    return std::max<size_t>(1, size_t(std::ceil(std::sqrt(double(numNodes)))));
+}
+
+// Cada router de la malla tiene un enlace de salida por dirección
+MeshTopology::MeshTopology(const TopologyConfig& config, size_t numNodes)
+    : Topology(config, numNodes, 4 * meshWidth(numNodes) * ((numNodes + meshWidth(numNodes) - 1) / meshWidth(numNodes))),
+      width(meshWidth(numNodes)),
+      height((numNodes + width - 1) / width) {}
+
+std::string MeshTopology::describe() const {
+    return "mesh " + std::to_string(width) + "x" + std::to_string(height);
+}
+
+// Ruteo XY (orden de dimensiones): libre de deadlock y determinista
+void MeshTopology::route(uint16_t src, uint16_t dst, std::vector<uint32_t>& path) const {
+    size_t x = src % width, y = src / width;
+    size_t dx = dst % width, dy = dst / width;
+    while (x != dx) {
+        Direction dir = x < dx ? EAST : WEST;
+        path.push_back(uint32_t(routerLink(4 * (y * width + x) + dir)));
+        x = dir == EAST ? x + 1 : x - 1;
+    }
+    while (y != dy) {
+        Direction dir = y < dy ? SOUTH : NORTH;
+        path.push_back(uint32_t(routerLink(4 * (y * width + x) + dir)));
+        y = dir == SOUTH ? y + 1 : y - 1;
+    }
+}
+
+// -------------------- Crossbar --------------------
+
+CrossbarTopology::CrossbarTopology(const TopologyConfig& config, size_t numNodes)
+    : Topology(config, numNodes, 0) {}
+
+std::string CrossbarTopology::describe() const {
+    return "crossbar " + std::to_string(numNodes) + "x" + std::to_string(numNodes);
+}
+
+// Solo compiten el puerto de salida del origen y el de entrada del destino
+void CrossbarTopology::route(uint16_t, uint16_t, std::vector<uint32_t>&) const {}
+
+std::unique_ptr<Topology> makeTopology(const TopologyConfig& config, size_t numNodes) {
+    switch (config.type) {
+        case TopologyType::RING:     return std::make_unique<RingTopology>(config, numNodes);
+        case TopologyType::MESH:     return std::make_unique<MeshTopology>(config, numNodes);
+        case TopologyType::CROSSBAR: return std::make_unique<CrossbarTopology>(config, numNodes);
+        case TopologyType::BUS:      break;
+    }
+    return nullptr;
+}
@@ -0,0 +1,106 @@
+#include "TraceReader.hpp"
+#include <cstring>
+#include <utility>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+TraceReader::TraceReader(const std::string& path) {
+    open(path);
+}
+
+TraceReader::~TraceReader() {
+    close();
+}
+
+TraceReader::TraceReader(TraceReader&& other) noexcept {
+    *this = std::move(other);
+}
+
+TraceReader& TraceReader::operator=(TraceReader&& other) noexcept {
+    if (this != &other) {
+        close();
+        mapping = std::exchange(other.mapping, nullptr);
+        mappingSize = std::exchange(other.mappingSize, 0);
+        records = std::exchange(other.records, nullptr);
+        count = std::exchange(other.count, 0);
+        lastError = std::move(other.lastError);
+    }
+    return *this;
+}
+
+bool TraceReader::open(const std::string& path) {
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        lastError = "No se pudo abrir " + path;
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || size_t(info.st_size) < sizeof(TraceFileHeader)) {
+        ::close(fd);
+        lastError = path + " no tiene encabezado de traza";
+        return false;
+    }
+
+    size_t fileSize = size_t(info.st_size);
+    void* data = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // El mapeo sigue siendo válido sin el descriptor
+    if (data == MAP_FAILED) {
+        lastError = "No se pudo mapear " + path;
+        return false;
+    }
+
+    TraceFileHeader expected;
+    TraceFileHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, expected.magic, sizeof(header.magic)) != 0 ||
+        header.version != expected.version || header.recordSize != sizeof(TraceRecord)) {
+        munmap(data, fileSize);
+        lastError = path + " no es una traza binaria compatible";
+        return false;
+    }
+
+    madvise(data, fileSize, MADV_SEQUENTIAL); // El uso típico es un recorrido de principio a fin
+    mapping = data;
+    mappingSize = fileSize;
+    // El encabezado mide 16 bytes: los registros quedan alineados a 8 dentro de la página
+    records = reinterpret_cast<const TraceRecord*>(static_cast<const char*>(data) + sizeof(TraceFileHeader));
+    count = (fileSize - sizeof(TraceFileHeader)) / sizeof(TraceRecord); // Un registro truncado al final se ignora
+    lastError.clear();
+    return true;
+}
+
+void TraceReader::close() {
+    if (mapping) munmap(mapping, mappingSize);
+    mapping = nullptr;
+    mappingSize = 0;
+    records = nullptr;
+    count = 0;
+}
+
+bool TraceReader::isOpen() const {
+    return mapping != nullptr;
+}
+
+const std::string& TraceReader::error() const {
+    return lastError;
+}
+
+size_t TraceReader::size() const {
+    return count;
+}
+
+const TraceRecord& TraceReader::operator[](size_t i) const {
+    return records[i];
+}
+
+const TraceRecord* TraceReader::begin() const {
+    return records;
+}
+
+const TraceRecord* TraceReader::end() const {
+    return records + count;
+}
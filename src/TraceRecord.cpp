@@ -0,0 +1,26 @@
+#include "TraceRecord.hpp"
+#include <charconv>
+
+// Agrega un entero sin signo al texto sin pasar por streams
+static void appendNumber(std::string& out, uint64_t value) {
+    char digits[24];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    out.append(digits, result.ptr);
+}
+
+void appendTraceLine(std::string& out, const TraceRecord& rec) {
+    out += traceOpName(rec.op);
+    out += ' ';
+    appendNumber(out, rec.direction);
+    out += ' ';
+    appendNumber(out, rec.size);
+    out += ' ';
+    switch (rec.peerKind) {
+        case TracePeer::PE:  out += 'P'; appendNumber(out, rec.peer); break;
+        case TracePeer::IC:  out += "IC"; break;
+        case TracePeer::ALL: out += "All"; break;
+    }
+    out += ' ';
+    appendNumber(out, rec.cycle);
+    out += '\n';
+}
@@ -0,0 +1,107 @@
+#include "TraceWriter.hpp"
+#include <chrono>
+#include <cstdio>
+
+bool parseTraceFormat(const std::string& name, TraceFormat& format) {
+    if (name == "text") format = TraceFormat::TEXT;
+    else if (name == "binary") format = TraceFormat::BINARY;
+    else return false;
+    return true;
+}
+
+TraceWriter::TraceWriter(const std::string& outputDir, size_t numPEs, TraceFormat format)
+    : format(format) {
+    const char* extension = format == TraceFormat::BINARY ? ".bin" : ".txt";
+    streams.reserve(numPEs + 1);
+    for (size_t i = 0; i <= numPEs; ++i) {
+        auto stream = std::make_unique<Stream>();
+        stream->ring = std::make_unique<TraceRecord[]>(RING_CAPACITY);
+        stream->path = outputDir + (i == INTERCONNECT_STREAM ? "/intconnect" : "/pe" + std::to_string(i - 1)) + extension;
+
+        // Trunca el archivo y escribe el encabezado (línea de columnas o TraceFileHeader)
+        std::FILE* file = std::fopen(stream->path.c_str(), "wb");
+        if (!file) {
+            if (firstFailure.empty()) firstFailure = stream->path;
+        } else {
+            if (format == TraceFormat::BINARY) {
+                TraceFileHeader header;
+                std::fwrite(&header, sizeof(header), 1, file);
+            } else {
+                std::fputs(TRACE_TEXT_HEADER, file);
+            }
+            std::fclose(file);
+        }
+        streams.push_back(std::move(stream));
+    }
+    writer = std::thread(&TraceWriter::writerLoop, this);
+}
+
+TraceWriter::~TraceWriter() {
+    close();
+}
+
+void TraceWriter::record(size_t stream, const TraceRecord& rec) {
+    Stream& s = *streams[stream];
+    uint64_t head = s.head.load(std::memory_order_relaxed);
+    // Anillo lleno: se espera al hilo escritor en lugar de descartar líneas
+    while (head - s.tail.load(std::memory_order_acquire) >= RING_CAPACITY) std::this_thread::yield();
+    s.ring[head & (RING_CAPACITY - 1)] = rec;
+    s.head.store(head + 1, std::memory_order_release);
+}
+
+void TraceWriter::close() {
+    if (!writer.joinable()) return;
+    running.store(false, std::memory_order_release);
+    writer.join();
+    // Los productores ya terminaron: se vacía lo que quede
+    for (auto& stream : streams) {
+        drain(*stream);
+        flush(*stream);
+    }
+}
+
+bool TraceWriter::ok() const {
+    return firstFailure.empty();
+}
+
+const std::string& TraceWriter::failedPath() const {
+    return firstFailure;
+}
+
+void TraceWriter::writerLoop() {
+    while (running.load(std::memory_order_acquire)) {
+        bool any = false;
+        for (auto& stream : streams) any |= drain(*stream);
+        if (!any) std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+}
+
+bool TraceWriter::drain(Stream& s) {
+    uint64_t tail = s.tail.load(std::memory_order_relaxed);
+    uint64_t head = s.head.load(std::memory_order_acquire);
+    if (tail == head) return false;
+
+    for (; tail != head; ++tail) {
+        const TraceRecord& rec = s.ring[tail & (RING_CAPACITY - 1)];
+        if (format == TraceFormat::BINARY) {
+            s.pending.append(reinterpret_cast<const char*>(&rec), sizeof(rec)); // El registro va tal cual al archivo
+        } else {
+            appendTraceLine(s.pending, rec);
+        }
+    }
+    s.tail.store(tail, std::memory_order_release);
+
+    if (s.pending.size() >= FLUSH_BYTES) flush(s);
+    return true;
+}
+
+// Se abre y cierra el archivo en cada volcado: con miles de PEs no se agotan los descriptores
+void TraceWriter::flush(Stream& s) {
+    if (s.pending.empty()) return;
+    std::FILE* file = std::fopen(s.path.c_str(), "ab");
+    if (file) {
+        std::fwrite(s.pending.data(), 1, s.pending.size(), file);
+        std::fclose(file);
+    }
+    s.pending.clear();
+}
@@ -0,0 +1,84 @@
+#include "WorkerPool.hpp"
+
+WorkerPool::WorkerPool(size_t numThreads) {
+    // El hilo llamador cuenta como uno de los trabajadores
+    for (size_t i = 1; i < numThreads; ++i) {
+        threads.emplace_back(&WorkerPool::workerLoop, this);
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    startCV.notify_all();
+    for (auto& thread : threads) thread.join();
+}
+
+size_t WorkerPool::size() const {
+    return threads.size() + 1;
+}
+
+void WorkerPool::runBatch(size_t count, TaskFn task, const void* context) {
+    if (count == 0) return;
+
+    // Con un solo hilo (o una sola tarea) no vale la pena despertar al grupo
+    if (threads.empty() || count == 1) {
+        for (size_t i = 0; i < count; ++i) task(context, i);
+        return;
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        // Ningún hilo puede seguir dentro de drain() del lote anterior al reiniciar el índice
+        doneCV.wait(lock, [this]() { return active == 0; });
+        currentTask = task;
+        currentContext = context;
+        taskCount = count;
+        pending = count;
+        nextIndex = 0; // Se publica al final: quien lo lea ya ve la tarea y el tamaño del lote
+        generation++;
+    }
+    startCV.notify_all();
+
+    drain();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    doneCV.wait(lock, [this]() { return pending == 0; });
+    currentTask = nullptr;
+    currentContext = nullptr;
+}
+
+void WorkerPool::drain() {
+    size_t done = 0;
+    size_t i;
+    while ((i = nextIndex.fetch_add(1)) < taskCount) {
+        currentTask.load()(currentContext.load(), i);
+        done++;
+    }
+    if (done == 0) return;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    pending -= done;
+    if (pending == 0) doneCV.notify_all();
+}
+
+void WorkerPool::workerLoop() {
+    uint64_t seenGeneration = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            startCV.wait(lock, [&]() { return stopping || generation != seenGeneration; });
+            if (stopping) return;
+            seenGeneration = generation;
+            active++;
+        }
+        drain();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            active--;
+            if (active == 0) doneCV.notify_all();
+        }
+    }
+}
@@ -0,0 +1,166 @@
+#include "WorkloadGenerator.hpp"
+#include <algorithm>
+
+bool parseTrafficPattern(const std::string& text, TrafficPattern& pattern) {
+    if (text == "uniform") pattern = TrafficPattern::UNIFORM;
+    else if (text == "hotspot") pattern = TrafficPattern::HOTSPOT;
+    else if (text == "producer-consumer") pattern = TrafficPattern::PRODUCER_CONSUMER;
+    else if (text == "strided") pattern = TrafficPattern::STRIDED;
+    else if (text == "all-to-all") pattern = TrafficPattern::ALL_TO_ALL;
+    else return false;
+    return true;
+}
+
+const char* trafficPatternName(TrafficPattern pattern) {
+    switch (pattern) {
+        case TrafficPattern::UNIFORM:           return "uniform";
+        case TrafficPattern::HOTSPOT:           return "hotspot";
+        case TrafficPattern::PRODUCER_CONSUMER: return "producer-consumer";
+        case TrafficPattern::STRIDED:           return "strided";
+        case TrafficPattern::ALL_TO_ALL:        return "all-to-all";
+    }
+    return "?";
+}
+
+namespace {
+
+constexpr uint64_t HOT_LINES = 4;       // Líneas calientes del patrón hotspot
+constexpr uint32_t HOT_PERCENT = 80;    // Porcentaje de accesos a las líneas calientes
+constexpr uint64_t BUFFER_LINES = 16;   // Buffer circular de cada par productor/consumidor
+constexpr uint64_t STRIDE_LINES = 4;    // Salto del patrón strided
+
+// Generador xorshift64 (el mismo esquema que el reemplazo aleatorio de la caché)
+class Xorshift {
+public:
+    Xorshift(uint64_t seed, uint16_t pe) {
+        // splitmix64 de (seed, pe) para que PEs y semillas cercanas no den secuencias parecidas
+        uint64_t z = seed * 0x9E3779B97F4A7C15ull + (uint64_t(pe) + 1) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        state = (z ^ (z >> 31)) | 1; // Nunca cero
+    }
+
+    uint64_t next() {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    }
+
+    // Entero uniforme en [0, n) sin sesgo de módulo apreciable (multiplicación de 128 bits)
+    uint64_t below(uint64_t n) {
+        return uint64_t((unsigned __int128)next() * n >> 64);
+    }
+
+    bool percent(uint32_t p) {
+        return below(100) < p;
+    }
+
+private:
+    uint64_t state;
+};
+
+// Emite instrucciones sobre líneas de caché hasta completar el programa
+class Emitter {
+public:
+    Emitter(InstructionStream& stream, const WorkloadConfig& config, uint64_t lines)
+        : stream(stream), config(config), lines(lines) {}
+
+    bool done() const { return stream.size() >= config.instructions; }
+
+    void read(uint64_t line) {
+        stream.append(Opcode::READ_MEM, address(line), config.lineSize);
+    }
+
+    // Escritura de la línea completa, de una vez o en partes consecutivas de writeBytes;
+    // si es compartida la sigue su invalidación (como en los tests)
+    void write(uint64_t line, bool shared) {
+        uint32_t addr = address(line);
+        uint32_t chunk = config.writeBytes ? std::min(config.writeBytes, config.lineSize) : config.lineSize;
+        for (uint32_t offset = 0; offset < config.lineSize && !done(); offset += chunk) {
+            stream.append(Opcode::WRITE_MEM, addr + offset, std::max<uint32_t>(chunk / 4, 1));
+        }
+        if (shared && !done()) stream.append(Opcode::BROADCAST_INVALIDATE, addr, 0);
+    }
+
+private:
+    uint32_t address(uint64_t line) const {
+        return uint32_t((line % lines) * config.lineSize);
+    }
+
+    InstructionStream& stream;
+    const WorkloadConfig& config;
+    uint64_t lines;
+};
+
+} // namespace
+
+InstructionStream generateWorkload(const WorkloadConfig& config, uint16_t pe, uint16_t numPEs) {
+    InstructionStream stream;
+    stream.reserve(config.instructions);
+
+    uint64_t lines = std::max<uint64_t>(config.memorySize / std::max<uint32_t>(config.lineSize, 1), 1);
+    uint64_t regionLines = std::max<uint64_t>(lines / std::max<uint16_t>(numPEs, 1), 1); // Partición por PE
+    uint64_t regionBase = uint64_t(pe) * regionLines;
+
+    Xorshift rng(config.seed, pe);
+    Emitter emit(stream, config, lines);
+
+    switch (config.pattern) {
+        case TrafficPattern::UNIFORM:
+            while (!emit.done()) {
+                uint64_t line = rng.below(lines);
+                if (rng.percent(config.readPercent)) emit.read(line);
+                else emit.write(line, true);
+            }
+            break;
+
+        case TrafficPattern::HOTSPOT: {
+            uint64_t hotLines = std::min(HOT_LINES, lines);
+            while (!emit.done()) {
+                uint64_t line = rng.percent(HOT_PERCENT) ? rng.below(hotLines) : rng.below(lines);
+                if (rng.percent(config.readPercent)) emit.read(line);
+                else emit.write(line, true);
+            }
+            break;
+        }
+
+        case TrafficPattern::PRODUCER_CONSUMER: {
+            // El par (2k, 2k+1) comparte un buffer; el productor lo llena en orden y el consumidor lo lee
+            uint64_t bufferBase = uint64_t(pe / 2) * BUFFER_LINES;
+            bool producer = pe % 2 == 0;
+            for (uint64_t slot = 0; !emit.done(); ++slot) {
+                uint64_t line = bufferBase + slot % BUFFER_LINES;
+                if (producer) emit.write(line, true);
+                else emit.read(line);
+            }
+            break;
+        }
+
+        case TrafficPattern::STRIDED: {
+            // Región privada: las escrituras no necesitan invalidación
+            uint64_t position = rng.below(regionLines);
+            while (!emit.done()) {
+                uint64_t line = regionBase + position;
+                if (rng.percent(config.readPercent)) emit.read(line);
+                else emit.write(line, false);
+                position = (position + STRIDE_LINES) % regionLines;
+            }
+            break;
+        }
+
+        case TrafficPattern::ALL_TO_ALL: {
+            // Lecturas de las particiones de los demás PEs por turnos; escrituras en la propia
+            for (uint64_t turn = 0; !emit.done();) {
+                if (rng.percent(config.readPercent)) {
+                    uint64_t owner = numPEs > 1 ? (pe + 1 + turn++ % (numPEs - 1)) % numPEs : pe;
+                    emit.read(owner * regionLines + rng.below(regionLines));
+                } else {
+                    emit.write(regionBase + rng.below(regionLines), true);
+                }
+            }
+            break;
+        }
+    }
+    return stream;
+}
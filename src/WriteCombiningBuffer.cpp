@@ -0,0 +1,106 @@
+#include "WriteCombiningBuffer.hpp"
+#include <algorithm>
+#include "Checkpoint.hpp"
+
+void WriteCombiningBuffer::configure(size_t count, uint32_t size) {
+    capacity = count;
+    lineSize = size;
+    fullMask = lineSize >= 64 ? ~uint64_t(0) : (uint64_t(1) << lineSize) - 1;
+    entries.clear();
+    entries.reserve(count);
+}
+
+bool WriteCombiningBuffer::enabled() const {
+    return capacity > 0;
+}
+
+bool WriteCombiningBuffer::empty() const {
+    return entries.empty();
+}
+
+void WriteCombiningBuffer::write(uint32_t addr, const uint8_t* data, size_t size,
+                                 std::vector<WriteCombiningEntry>& flushed) {
+    while (size > 0) {
+        uint32_t offset = addr % lineSize;
+        uint32_t line = addr - offset;
+        size_t count = std::min<size_t>(size, lineSize - offset);
+
+        auto it = std::find_if(entries.begin(), entries.end(),
+                               [&](const WriteCombiningEntry& entry) { return entry.line == line; });
+        if (it != entries.end()) {
+            combinedWrites++;
+        } else {
+            if (entries.size() >= capacity) flushOldest(flushed); // Sin lugar: sale la entrada más antigua
+            entries.push_back(WriteCombiningEntry{});
+            it = entries.end() - 1;
+            it->line = line;
+        }
+
+        std::copy(data, data + count, it->data.begin() + offset);
+        uint64_t bits = count >= 64 ? ~uint64_t(0) : (uint64_t(1) << count) - 1;
+        it->mask |= bits << offset;
+
+        if (it->mask == fullMask) { // Línea completa: sale como una sola transacción
+            fullLines++;
+            flushed.push_back(*it);
+            entries.erase(it);
+        }
+
+        addr += uint32_t(count);
+        data += count;
+        size -= count;
+    }
+}
+
+bool WriteCombiningBuffer::drain(uint32_t addr, std::vector<WriteCombiningEntry>& flushed) {
+    uint32_t line = addr - addr % lineSize;
+    auto it = std::find_if(entries.begin(), entries.end(),
+                           [&](const WriteCombiningEntry& entry) { return entry.line == line; });
+    if (it == entries.end()) return false;
+    flushed.push_back(*it);
+    entries.erase(it);
+    return true;
+}
+
+void WriteCombiningBuffer::drainAll(std::vector<WriteCombiningEntry>& flushed) {
+    flushed.insert(flushed.end(), entries.begin(), entries.end());
+    entries.clear();
+}
+
+void WriteCombiningBuffer::flushOldest(std::vector<WriteCombiningEntry>& flushed) {
+    flushed.push_back(entries.front());
+    entries.erase(entries.begin());
+}
+
+uint64_t WriteCombiningBuffer::getCombinedWrites() const {
+    return combinedWrites;
+}
+
+uint64_t WriteCombiningBuffer::getFullLines() const {
+    return fullLines;
+}
+
+void WriteCombiningBuffer::saveState(CheckpointWriter& out) const {
+    out.put<uint64_t>(entries.size());
+    for (const WriteCombiningEntry& entry : entries) {
+        out.put(entry.line);
+        out.put(entry.mask);
+        out.putBytes(entry.data.data(), lineSize);
+    }
+    out.put(combinedWrites);
+    out.put(fullLines);
+}
+
+void WriteCombiningBuffer::loadState(CheckpointReader& in) {
+    uint64_t count = in.get<uint64_t>();
+    if (count > capacity) in.fail();
+    if (!in.ok()) return;
+    entries.assign(size_t(count), WriteCombiningEntry{});
+    for (WriteCombiningEntry& entry : entries) {
+        in.get(entry.line);
+        in.get(entry.mask);
+        in.getBytes(entry.data.data(), lineSize);
+    }
+    in.get(combinedWrites);
+    in.get(fullLines);
+}
@@ -1,12 +1,7 @@
 #include <iostream>
-#include <PE.hpp>
-#include "Interconnect.hpp"
-#include <mutex>
-#include <fstream>
-
-std::mutex cout_mutex; // Declaración del mutex global para proteger std::cout
-std::mutex cin_mutex; // Declaración del mutex global para proteger std::cin
-int executionMode = 0; // Número para modo de ejecución (0 -> FIFO, 1 -> Prioridad)
+#include <algorithm>
+#include "Simulation.hpp"
+#include "Stats.hpp"
 
 int main(int argc, char *argv[]) {
 
@@ -15,82 +10,310 @@ int main(int argc, char *argv[]) {
     //  -------------------------------------------
 
     // Verificar si se proporcionaron argumentos suficientes
-    if (argc != 3) {
-        std::cerr << "Uso: " << argv[0] << " <modo_ejecución (0|1)> <número_test (1|2)>\n";
+    if (argc < 3) {
+        std::cerr << "Uso: " << argv[0] << " <modo_ejecución (0-4)> <número_test (1|2) | patrón sintético> [opciones]\n"
+                  << "Modos: 0 FIFO, 1 Prioridad, 2 Weighted Round-Robin, 3 Deficit Round-Robin, 4 Prioridad con envejecimiento\n"
+                  << "Patrones: uniform, hotspot, producer-consumer, strided, all-to-all\n"
+                  << "Opciones:\n"
+                  << "  --run=interactive|batch|step  Modo de avance (por defecto interactive)\n"
+                  << "  --break-cycle=N               (step) Pausa solo en el ciclo N\n"
+                  << "  --break-pe=N                  (step) Pausa solo en eventos del PE N\n"
+                  << "  --break-msg=TIPO              (step) Pausa solo en el tipo de mensaje TIPO\n"
+                  << "  --verbose                     Imprime los eventos en consola también en modo batch\n"
+                  << "  --pes=N                       Cantidad de PEs (por defecto 8)\n"
+                  << "  --workers=N                   Hilos que ejecutan los PEs en modo batch (por defecto 1)\n"
+                  << "  --coherence=broadcast|directory  Esquema de invalidación (por defecto broadcast)\n"
+                  << "  --protocol=none|mesi|moesi    Protocolo de coherencia de las cachés (por defecto none: write-through)\n"
+                  << "  --cache-size=BYTES            Tamaño de la caché de cada PE (por defecto 2048)\n"
+                  << "  --assoc=N                     Vías por conjunto (por defecto 1, mapeo directo)\n"
+                  << "  --line=BYTES                  Tamaño de línea (por defecto 16)\n"
+                  << "  --repl=lru|plru|random        Política de reemplazo (por defecto lru)\n"
+                  << "  --write-policy=through|back   (sin protocolo) Política de escritura de la caché (por defecto through)\n"
+                  << "  --wc-buffers=N                (write-through) Entradas del buffer de write-combining por PE (por defecto 0)\n"
+                  << "  --trace=text|binary           Formato de los archivos de salida (por defecto text)\n"
+                  << "  --stats=RUTA                  Guarda los contadores al terminar (CSV si termina en .csv, si no JSON)\n"
+                  << "  --mem-size=BYTES[K|M|G]       Tamaño de la memoria principal (por defecto 16K, máximo 4G)\n"
+                  << "  --mem-file=RUTA               Respalda la memoria con un archivo mapeado (mmap)\n"
+                  << "  --mem-image=RUTA              Precarga una imagen binaria desde la dirección 0\n"
+                  << "  --mem-snapshot=RUTA           Guarda la memoria al terminar la simulación\n"
+                  << "  --mem-banks=N                 Bancos de memoria entrelazados (por defecto 1)\n"
+                  << "  --mem-interleave=BYTES        Bytes consecutivos por banco (por defecto 64)\n"
+                  << "  --mem-latency=N               Ciclos de acceso de un banco (por defecto 0)\n"
+                  << "  --mem-occupancy=N             Ciclos que un banco queda ocupado por acceso (por defecto 0)\n"
+                  << "  --bus=atomic|split            Transacciones atómicas o divididas (por defecto atomic)\n"
+                  << "  --inflight=N                  (split) Transacciones en vuelo como máximo (por defecto 8)\n"
+                  << "  --topology=bus|ring|mesh|crossbar  Red entre los PEs y la memoria (por defecto bus)\n"
+                  << "  --link-bw=BYTES               Bytes por ciclo de cada enlace o del bus (por defecto 8)\n"
+                  << "  --hop-latency=N               (ring|mesh|crossbar) Ciclos por salto (por defecto 1)\n"
+                  << "  --instructions=N              (sintético) Instrucciones por PE (por defecto 1000)\n"
+                  << "  --seed=N                      (sintético) Semilla del generador (por defecto 1)\n"
+                  << "  --read-percent=N              (sintético) Porcentaje de lecturas (por defecto 70)\n"
+                  << "  --write-bytes=N               (sintético) Bytes por escritura, múltiplo de 4 (por defecto la línea)\n"
+                  << "  --mshrs=N                     Registros de fallos pendientes por PE (por defecto 0: sin límite)\n"
+                  << "  --checkpoint=RUTA             Guarda el estado completo de la simulación (requiere --checkpoint-at)\n"
+                  << "  --checkpoint-at=N             Ciclo antes del cual se guarda el checkpoint\n"
+                  << "  --checkpoint-exit             Termina después de guardar el checkpoint\n"
+                  << "  --restore=RUTA                Continúa la simulación desde un checkpoint\n"
+                  << "  --sample-period=N             Simulación muestreada: período en instrucciones por PE (por defecto 0: sin muestreo)\n"
+                  << "  --sample-window=N             Instrucciones por PE de cada ventana detallada (por defecto 1000)\n"
+                  << "  --sample-warmup=N             Ciclos al comienzo de cada ventana que no se miden (por defecto 500)\n";
         return 1;
     }
 
     // Procesar el primer argumento
+    SimulationConfig config;
     try {
-        executionMode = std::stoi(argv[1]);
-        if (executionMode < 0 || executionMode > 1) {
-            std::cerr << "Error: Modo de ejecución inválido. Debe ser 0 (FIFO) o 1 (Prioridad).\n";
+        config.arbiterMode = std::stoi(argv[1]);
+        if (config.arbiterMode < 0 || config.arbiterMode > 4) {
+            std::cerr << "Error: Modo de ejecución inválido. Debe ser 0 (FIFO), 1 (Prioridad), 2 (WRR), 3 (DRR) o 4 (Prioridad con envejecimiento).\n";
             return 1;
         }
-        std::string executionString;
-        if (executionMode == 0) executionString = "0) FIFO"; else executionString = "1) Prioridad";
-        std::cout << "<< Modo de ejecución seleccionado: " << executionString << " >>\n";
+        std::cout << "<< Modo de ejecución seleccionado: " << config.arbiterMode << ") " << arbiterName(config.arbiterMode) << " >>\n";
     } catch (...) {
-        std::cerr << "Error: El primer argumento debe ser un número válido (0 o 1).\n";
+        std::cerr << "Error: El primer argumento debe ser un número válido (0 a 4).\n";
         return 1;
     }
 
-    // Procesar el segundo argumento
-    int testNumber;
-    try {
-        testNumber = std::stoi(argv[2]);
-        if (testNumber != 1 && testNumber != 2) {
-            std::cerr << "Error: El número de test debe ser 1 o 2.\n";
+    // Procesar el segundo argumento: número de test o patrón de workload sintético
+    if (parseTrafficPattern(argv[2], config.workload.pattern)) {
+        config.synthetic = true;
+        std::cout << "<< Ejecutando workload sintético " << argv[2] << " >>\n";
+    } else {
+        try {
+            config.testNumber = std::stoi(argv[2]);
+            if (config.testNumber != 1 && config.testNumber != 2) {
+                std::cerr << "Error: El número de test debe ser 1 o 2.\n";
+                return 1;
+            }
+            std::cout << "<< Ejecutando Test " << config.testNumber << " >>\n";
+        } catch (...) {
+            std::cerr << "Error: El segundo argumento debe ser un número de test (1 o 2) o un patrón sintético "
+                      << "(uniform|hotspot|producer-consumer|strided|all-to-all).\n";
             return 1;
         }
-        std::cout << "<< Ejecutando Test " << testNumber << " >>\n";
-    } catch (...) {
-        std::cerr << "Error: El segundo argumento debe ser un número válido (1 o 2).\n";
+    }
+
+    // Procesar las opciones adicionales (las de salida las maneja main; el resto, la configuración)
+    std::string memorySnapshot;
+    std::string statsPath;
+    for (int i = 3; i < argc; ++i) {
+        std::string arg = argv[i];
+        std::string error;
+        if (arg.rfind("--mem-snapshot=", 0) == 0) {
+            memorySnapshot = arg.substr(15);
+        } else if (arg.rfind("--stats=", 0) == 0) {
+            statsPath = arg.substr(8);
+        } else if (!parseSimulationOption(arg, config, error)) {
+            std::cerr << "Error: " << error << "\n";
+            return 1;
+        }
+    }
+    std::string configError = simulationConfigError(config);
+    if (!configError.empty()) {
+        std::cerr << "Error: " << configError << "\n";
         return 1;
     }
 
+    // Las pausas interactivas necesitan un orden de ejecución predecible: solo batch usa varios hilos
+    if (config.runMode != RunMode::BATCH && config.workerThreads > 1) {
+        std::cout << "<< --workers se ignora fuera del modo batch >>\n";
+        config.workerThreads = 1;
+    }
+
     //  -------------------------------------------
-    //  |          Preparar Docs de Salida        |
+    //  | Inicio de la Funcionalidad del programa |
     //  -------------------------------------------
 
-    std::vector<std::string> fileNames = {
-        "../output/intconnect.txt"
-    };
-    for (int i = 0; i < 8; ++i) {
-        fileNames.push_back("../output/pe" + std::to_string(i) + ".txt");
-    }
-    for (const auto& fileName : fileNames) {
-        std::ofstream ofs(fileName, std::ios::trunc); // Abre el archivo y lo trunca (vacía)
-        if (!ofs) {
-            std::cerr << "Error al intentar limpiar el archivo: " << fileName << "\n";
-        } else {
-            ofs << "Instrucción Recibido/Enviado Tamaño Fuente/Destino Ciclo\n";
+    // Trazas, kernel de simulación por eventos discretos, interconnect y PEs de esta configuración
+    Simulation simulation(config);
+    Simulator& simulator = simulation.getSimulator();
+    Interconnect& interconnect = simulation.getInterconnect();
+    const std::vector<std::unique_ptr<PE>>& pes = simulation.getPEs();
+    const int numPEs = config.numPEs;
+
+    if (config.synthetic) {
+        std::cout << "<< Generando " << config.workload.instructions << " instrucciones por PE ("
+                  << trafficPatternName(config.workload.pattern) << ", semilla " << config.workload.seed << ") >>\n";
+    } else {
+        std::cout << "<< Cargando instrucciones desde: " << simulation.instructionPath() << " >>\n";
+    }
+    if (config.runMode == RunMode::INTERACTIVE) std::cout << "<< Presiona Enter para avanzar al siguiente paso >>\n";
+    else if (config.runMode == RunMode::STEP) std::cout << "<< Modo step: pausa solo en los puntos de quiebre >>\n";
+
+    if (!simulation.prepare()) return 1;
+    if (!config.restorePath.empty()) {
+        std::cout << "<< Estado restaurado desde " << config.restorePath << " (ciclo " << simulator.now() << ", "
+                  << simulator.getProcessedEvents() << " eventos) >>\n";
+    }
+    std::cout << "<< " << numPEs << " PEs sobre " << simulator.getWorkerThreads() << " hilo(s) >>\n";
+
+    // Procesa todos los eventos hasta que no queden instrucciones ni mensajes (con --checkpoint, se
+    // guarda el estado en el camino)
+    if (!simulation.run()) return 1;
+    if (!config.checkpointPath.empty()) {
+        std::cout << "<< Checkpoint guardado en " << config.checkpointPath << " antes del ciclo "
+                  << config.checkpointCycle << " >>\n";
+        if (config.checkpointExit) {
+            std::cout << "<< Simulación detenida en el ciclo " << simulator.now() << " ("
+                      << simulator.getProcessedEvents() << " eventos) >>\n";
+            simulation.getTraceWriter().close();
+            return 0;
         }
     }
 
-    //  -------------------------------------------
-    //  | Inicio de la Funcionalidad del programa |
-    //  -------------------------------------------
+    std::cout << "<< Simulación terminada en el ciclo " << simulator.now() << " ("
+              << simulator.getProcessedEvents() << " eventos) >>\n";
+    if (config.sampling.enabled()) {
+        // Los ciclos, el tráfico y las latencias de los demás resúmenes cubren solo las ventanas detalladas
+        const SamplingResult& sampling = simulation.getSampling();
+        double cycles = sampling.estimatedCycles(), cyclesError = sampling.estimatedCyclesHalfWidth();
+        double instructions = double(sampling.totalInstructions());
+        std::cout << "<< Muestreo: " << sampling.windows << " ventanas (" << sampling.latency.count()
+                  << " con latencia medida) de " << config.sampling.window << " instrucciones por PE cada " << config.sampling.period << "; " << sampling.detailedInstructions
+                  << " instrucciones en detalle (" << sampling.detailedCycles << " ciclos) y "
+                  << sampling.fastForwardInstructions << " en avance rápido >>\n";
+        if (sampling.cyclesPerInstruction.count() > 0) {
+            std::cout << "<< Estimación del programa completo (95%): " << uint64_t(cycles + 0.5) << " ± "
+                      << uint64_t(cyclesError + 0.5) << " ciclos, IPC " << instructions / cycles << " (entre "
+                      << instructions / (cycles + cyclesError) << " y "
+                      << (cycles > cyclesError ? instructions / (cycles - cyclesError) : instructions / cycles) << ")";
+            if (sampling.latencyEstimable()) {
+                std::cout << ", latencia media " << sampling.latency.mean() << " ± " << sampling.latency.halfWidth() << " ciclos";
+            }
+            std::cout << " >>\n";
+        }
+        if (sampling.latency.count() == 0) {
+            std::cout << "<< Latencia sin muestras: ninguna ventana duró más que el calentamiento (reducir "
+                      << "--sample-warmup o agrandar --sample-window) >>\n";
+        } else if (!sampling.latencyEstimable()) {
+            std::cout << "<< Latencia no estimable: en " << sampling.saturatedWindows << " de " << sampling.windows
+                      << " ventanas los PEs emiten más rápido de lo que el interconnect atiende, así que en la ejecución "
+                      << "completa la cola crece durante todo el programa (las ventanas miden " << sampling.latency.mean()
+                      << " ciclos, solo con su propia cola; limitar con --mshrs) >>\n";
+        }
+    }
+    if (config.coherenceMode == CoherenceMode::DIRECTORY) {
+        std::cout << "<< Coherencia por directorio: " << interconnect.getInvalidationsSent()
+                  << " invalidaciones enviadas, " << interconnect.getInvalidationsAvoided()
+                  << " evitadas respecto a broadcast >>\n";
+    }
+    const InterconnectStats& interconnectStats = interconnect.getStats();
+    if (config.protocol != CoherenceProtocol::NONE) {
+        uint64_t writeHits = 0;
+        for (const auto& pe : pes) writeHits += pe->getStats().writeHits;
+        size_t flushed = interconnect.writeBackCaches(); // Las líneas sucias llegan a memoria antes de la instantánea
+        std::cout << "<< Protocolo " << coherenceProtocolName(config.protocol) << ": " << writeHits << " escrituras locales, "
+                  << interconnectStats.cacheToCacheTransfers << " transferencias entre cachés, "
+                  << interconnectStats.writebacks << " write-backs, " << interconnect.getInvalidationsSent()
+                  << " invalidaciones; " << flushed << " líneas sucias volcadas al terminar >>\n";
+    } else if (config.cacheConfig.writePolicy == WritePolicy::WRITE_BACK) {
+        uint64_t evicted = 0, ownInvalidations = 0;
+        for (const auto& pe : pes) {
+            evicted += pe->getStats().writebacks;
+            ownInvalidations += pe->getStats().invalidationFlushes;
+        }
+        size_t flushed = interconnect.writeBackCaches();
+        std::cout << "<< Write-back: " << evicted << " líneas sucias escritas al reemplazarlas, "
+                  << ownInvalidations << " antes de un BROADCAST_INVALIDATE propio, "
+                  << interconnectStats.recalledLines << " al invalidarlas otro PE; " << flushed
+                  << " volcadas al terminar >>\n";
+    }
+    if (config.writeCombiningEntries > 0) {
+        uint64_t combined = 0, fullLines = 0;
+        for (const auto& pe : pes) {
+            combined += pe->getWriteCombining().getCombinedWrites();
+            fullLines += pe->getWriteCombining().getFullLines();
+        }
+        std::cout << "<< Write-combining (" << config.writeCombiningEntries << " entradas por PE): " << combined
+                  << " escrituras combinadas, " << fullLines << " líneas completas en una transacción >>\n";
+    }
+    std::cout << "<< Tráfico del interconnect: " << interconnectStats.trafficBytes() << " bytes, "
+              << interconnectStats.memoryReads << " lecturas y " << interconnectStats.memoryWrites
+              << " escrituras de memoria >>\n";
 
-    Interconnect interconnect;
-    interconnect.start();
+    uint64_t totalCycles = std::max<uint64_t>(simulator.now(), 1);
+    if (const Topology* topology = interconnect.getTopology()) {
+        // Utilización de los enlaces: promedio, el más cargado y el puerto de entrada de la memoria
+        uint64_t linkCycles = 0, maxLinkCycles = 0;
+        for (size_t link = 0; link < topology->getNumLinks(); ++link) {
+            linkCycles += topology->getLinkBusyCycles(link);
+            maxLinkCycles = std::max(maxLinkCycles, topology->getLinkBusyCycles(link));
+        }
+        uint64_t memoryPortCycles = topology->getLinkBusyCycles(topology->ejectLink(uint16_t(numPEs)));
+        std::cout << "<< Red " << topology->describe() << " (" << config.topologyConfig.linkBytesPerCycle << " B/ciclo, "
+                  << config.topologyConfig.hopLatency << " ciclo(s) por salto): " << topology->getTransfers() << " mensajes, "
+                  << (topology->getTransfers() ? double(topology->getTotalHops()) / double(topology->getTransfers()) : 0.0)
+                  << " enlaces por mensaje; utilización media "
+                  << 100.0 * double(linkCycles) / double(topology->getNumLinks() * totalCycles) << "%, máxima "
+                  << 100.0 * double(maxLinkCycles) / double(totalCycles) << "%, puerto de memoria "
+                  << 100.0 * double(memoryPortCycles) / double(totalCycles) << "%; "
+                  << interconnect.getCompletedTransactions() << " transacciones, hasta "
+                  << interconnect.getPeakInFlight() << " en vuelo >>\n";
+    } else {
+        std::cout << "<< Bus " << (config.busMode == BusMode::SPLIT ? "split" : "atomic") << ": "
+                  << 100.0 * double(interconnect.getBusBusyCycles()) / double(totalCycles) << "% de utilización ("
+                  << interconnect.getBusBusyCycles() << " de " << simulator.now() << " ciclos), "
+                  << interconnect.getCompletedTransactions() << " transacciones";
+        if (config.busMode == BusMode::SPLIT) std::cout << ", hasta " << interconnect.getPeakInFlight() << " en vuelo";
+        std::cout << " >>\n";
+    }
 
-    std::vector<std::unique_ptr<PE>> pes;
-    std::string instructionPath = "../workloads/test" + std::to_string(testNumber);
-    std::cout << "<< Cargando instrucciones desde: " << instructionPath << " >>\n";
-    std::cout << "<< Presiona Enter para avanzar al siguiente paso >>\n";
+    // Latencia de solicitud a respuesta: total y dispersión entre PEs de la cola (p99)
+    LatencyHistogram allLatencies;
+    int bestPE = 0, worstPE = 0;
+    for (int i = 0; i < numPEs; ++i) {
+        const LatencyHistogram& latency = interconnect.getLatency(uint16_t(i));
+        allLatencies.merge(latency);
+        if (latency.percentile(99) < interconnect.getLatency(uint16_t(bestPE)).percentile(99)) bestPE = i;
+        if (latency.percentile(99) > interconnect.getLatency(uint16_t(worstPE)).percentile(99)) worstPE = i;
+    }
+    if (allLatencies.count() > 0) {
+        std::cout << "<< Latencia (" << arbiterName(config.arbiterMode) << "): media " << allLatencies.mean()
+                  << ", p50 " << allLatencies.percentile(50) << ", p95 " << allLatencies.percentile(95)
+                  << ", p99 " << allLatencies.percentile(99) << ", máx " << allLatencies.max()
+                  << " ciclos; p99 por PE entre " << interconnect.getLatency(uint16_t(bestPE)).percentile(99)
+                  << " (PE " << bestPE << ") y " << interconnect.getLatency(uint16_t(worstPE)).percentile(99)
+                  << " (PE " << worstPE << ") >>\n";
+        if (numPEs <= 16) {
+            for (int i = 0; i < numPEs; ++i) {
+                const LatencyHistogram& latency = interconnect.getLatency(uint16_t(i));
+                std::cout << "<<   PE " << i << ": " << latency.count() << " solicitudes, p50 " << latency.percentile(50)
+                          << ", p95 " << latency.percentile(95) << ", p99 " << latency.percentile(99)
+                          << ", máx " << latency.max() << " >>\n";
+            }
+        }
+    }
 
-    for (int i = 0; i < 8; i++) {
-        auto pe = std::make_unique<PE>(i, 0x00 + i, &interconnect);
-        interconnect.registerPE(i, pe.get());
-        pes.push_back(std::move(pe));
-        pes[i]->loadInstructions(instructionPath + "/workload_" + std::to_string(i) + ".txt");
+    if (config.mshrCount > 0) {
+        uint64_t primary = 0, merged = 0, stallCycles = 0, outstandingCycles = 0, missCycles = 0;
+        size_t peak = 0;
+        for (const auto& pe : pes) {
+            const MSHRFile& mshrs = pe->getMSHRs();
+            primary += mshrs.getPrimaryMisses();
+            merged += mshrs.getSecondaryMisses();
+            outstandingCycles += mshrs.getOutstandingCycles();
+            missCycles += mshrs.getMissCycles();
+            peak = std::max(peak, mshrs.getPeakOutstanding());
+            stallCycles += pe->getStallCycles();
+        }
+        std::cout << "<< MSHRs (" << config.mshrCount << " por PE): " << primary << " fallos primarios, " << merged
+                  << " combinados, " << stallCycles << " ciclos detenidos, MLP promedio "
+                  << (missCycles ? double(outstandingCycles) / double(missCycles) : 0.0) << " (máx " << peak << ") >>\n";
     }
 
-    for (auto& pe : pes) pe->start();
-    for (auto& pe : pes) pe->join();
+    MainMemory& mainMemory = interconnect.getMainMemory();
+    if (mainMemory.getBanks() > 1 || config.memoryConfig.bankLatency > 0 || config.memoryConfig.bankOccupancy > 0) {
+        std::cout << "<< Memoria: " << mainMemory.getBanks() << " banco(s), " << mainMemory.getBankAccesses()
+                  << " accesos, " << mainMemory.getBankConflictCycles() << " ciclos de espera por conflicto de banco >>\n";
+    }
+    if (!memorySnapshot.empty() && mainMemory.saveSnapshot(memorySnapshot)) {
+        std::cout << "<< Memoria guardada en " << memorySnapshot << " >>\n";
+    }
+    if (!statsPath.empty() && writeStats(statsPath, simulator, interconnect, pes)) {
+        std::cout << "<< Estadísticas guardadas en " << statsPath << " >>\n";
+    }
 
-    interconnect.stop();
+    simulation.getTraceWriter().close(); // Vuelca las trazas pendientes antes de graficar
 
     //  -------------------------------------------
     //  |     Ejecución Script de Graficación     |
@@ -0,0 +1,317 @@
+// Barrido de parámetros: corre en paralelo una simulación por cada punto de la grilla y junta los
+// resultados en una sola tabla.
+// Uso:
+//   sweep [--modes=0,1,...] [--workloads=1,2,uniform,...] [--pes=8,16,...] [--link-bw=8,16,...]
+//         [--cache=BYTESxVÍASxLÍNEA,...] [--topology=bus,mesh,...] [--jobs=N] [--out=CARPETA]
+//         [opciones de Interconnect_A2...]
+// Cada eje es una lista separada por comas (por defecto, el valor de Interconnect_A2). Las demás
+// opciones se aplican a todas las instancias. Cada instancia corre en modo batch, en silencio, con
+// sus trazas y su stats.json en CARPETA/<nombre>; la tabla queda en CARPETA/results.csv.
+// Con --restore=RUTA todas las instancias parten del mismo checkpoint (ej: cachés ya calentadas); solo
+// pueden variar los ejes que no cambian su forma (--link-bw). Con --sample-period las columnas de ciclos
+// y latencia media son las estimaciones del programa completo; las demás cubren las ventanas detalladas.
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Simulation.hpp"
+#include "Stats.hpp"
+
+namespace {
+
+// Un punto de la grilla
+struct SweepPoint {
+    std::string name; // Carpeta de salida y fila de la tabla
+    SimulationConfig config;
+};
+
+// Resultado de una instancia (ok = false si no se pudo preparar)
+struct SweepResult {
+    bool ok = false;
+    uint64_t cycles = 0;
+    uint64_t events = 0;
+    uint64_t transactions = 0;
+    double utilization = 0.0; // Bus o promedio de los enlaces de la topología, en %
+    double latencyMean = 0.0;
+    uint64_t latencyP50 = 0;
+    uint64_t latencyP95 = 0;
+    uint64_t latencyP99 = 0;
+    uint64_t trafficBytes = 0;
+    uint64_t memoryReads = 0;
+    uint64_t memoryWrites = 0;
+    uint64_t invalidations = 0;
+    double hitRate = 0.0;
+    double wallMs = 0.0;
+};
+
+std::vector<std::string> splitList(const std::string& text) {
+    std::vector<std::string> items;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (!item.empty()) items.push_back(item);
+    }
+    return items;
+}
+
+// "2048x2x16" → tamaño, vías y línea
+bool parseCacheGeometry(const std::string& text, CacheConfig& config) {
+    unsigned long size = 0, assoc = 0, line = 0;
+    char extra = 0;
+    if (std::sscanf(text.c_str(), "%lux%lux%lu%c", &size, &assoc, &line, &extra) != 3) return false;
+    config.sizeBytes = size;
+    config.associativity = assoc;
+    config.lineSize = line;
+    return true;
+}
+
+// Aplica la opción equivalente de Interconnect_A2 ("--pes=" + valor) sobre la configuración
+bool applyAxis(const std::string& option, const std::string& value, SimulationConfig& config) {
+    std::string error;
+    if (parseSimulationOption(option + value, config, error)) return true;
+    std::cerr << "Error: " << error << "\n";
+    return false;
+}
+
+SweepResult runPoint(const SweepPoint& point) {
+    SweepResult result;
+    auto start = std::chrono::steady_clock::now();
+
+    std::filesystem::create_directories(point.config.outputDir);
+    Simulation simulation(point.config);
+    if (!simulation.prepare() || !simulation.run()) return result;
+
+    Simulator& simulator = simulation.getSimulator();
+    Interconnect& interconnect = simulation.getInterconnect();
+    const auto& pes = simulation.getPEs();
+    const InterconnectStats& stats = interconnect.getStats();
+    if (point.config.protocol != CoherenceProtocol::NONE || point.config.cacheConfig.writePolicy == WritePolicy::WRITE_BACK) {
+        interconnect.writeBackCaches();
+    }
+    writeStats(point.config.outputDir + "/stats.json", simulator, interconnect, pes);
+    simulation.getTraceWriter().close();
+
+    result.ok = true;
+    result.cycles = simulator.now();
+    result.events = simulator.getProcessedEvents();
+    result.transactions = interconnect.getCompletedTransactions();
+    uint64_t totalCycles = std::max<uint64_t>(simulator.now(), 1);
+    if (const Topology* topology = interconnect.getTopology()) {
+        uint64_t linkCycles = 0;
+        for (size_t link = 0; link < topology->getNumLinks(); ++link) linkCycles += topology->getLinkBusyCycles(link);
+        result.utilization = 100.0 * double(linkCycles) / double(topology->getNumLinks() * totalCycles);
+    } else {
+        result.utilization = 100.0 * double(interconnect.getBusBusyCycles()) / double(totalCycles);
+    }
+
+    LatencyHistogram latency;
+    uint64_t hits = 0, reads = 0;
+    for (const auto& pe : pes) {
+        latency.merge(interconnect.getLatency(uint16_t(pe->getId())));
+        hits += pe->getStats().readHits;
+        reads += pe->getStats().readHits + pe->getStats().readMisses;
+    }
+    result.latencyMean = latency.mean();
+    result.latencyP50 = latency.percentile(50);
+    result.latencyP95 = latency.percentile(95);
+    result.latencyP99 = latency.percentile(99);
+    const SamplingResult& sampling = simulation.getSampling();
+    if (sampling.cyclesPerInstruction.count() > 0) { // Muestreo: estimaciones del programa completo
+        result.cycles = uint64_t(sampling.estimatedCycles() + 0.5);
+        result.latencyMean = sampling.latencyEstimable() ? sampling.latency.mean() : std::numeric_limits<double>::quiet_NaN();
+    }
+    result.trafficBytes = stats.trafficBytes();
+    result.memoryReads = stats.memoryReads;
+    result.memoryWrites = stats.memoryWrites;
+    result.invalidations = interconnect.getInvalidationsSent();
+    result.hitRate = reads ? double(hits) / double(reads) : 0.0;
+    result.wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+void writeRow(std::ostream& out, const SweepPoint& point, const SweepResult& result) {
+    const SimulationConfig& config = point.config;
+    out << point.name << "," << config.arbiterMode << ","
+        << (config.synthetic ? trafficPatternName(config.workload.pattern) : "test" + std::to_string(config.testNumber))
+        << "," << config.numPEs << "," << config.topologyConfig.linkBytesPerCycle << ","
+        << config.cacheConfig.sizeBytes << "x" << config.cacheConfig.associativity << "x" << config.cacheConfig.lineSize
+        << "," << topologyName(config.topologyConfig.type) << "," << (result.ok ? "ok" : "error");
+    if (result.ok) {
+        out << "," << result.cycles << "," << result.events << "," << result.transactions << ","
+            << result.utilization << "," << result.latencyMean << "," << result.latencyP50 << ","
+            << result.latencyP95 << "," << result.latencyP99 << "," << result.trafficBytes << ","
+            << result.memoryReads << "," << result.memoryWrites << "," << result.invalidations << ","
+            << result.hitRate << "," << result.wallMs;
+    } else {
+        out << ",,,,,,,,,,,,,,";
+    }
+    out << "\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::vector<std::string> modes = {"0"}, workloads = {"1"}, peCounts, linkBandwidths, caches, topologies;
+    unsigned jobs = std::max(1u, std::thread::hardware_concurrency());
+    std::string outDir = "sweep";
+
+    // Configuración común: modo batch, sin consola y un hilo por instancia (el paralelismo es entre instancias)
+    SimulationConfig base;
+    base.runMode = RunMode::BATCH;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        std::string error;
+        if (arg.rfind("--modes=", 0) == 0) {
+            modes = splitList(arg.substr(8));
+        } else if (arg.rfind("--workloads=", 0) == 0) {
+            workloads = splitList(arg.substr(12));
+        } else if (arg.rfind("--pes=", 0) == 0) {
+            peCounts = splitList(arg.substr(6));
+        } else if (arg.rfind("--link-bw=", 0) == 0) {
+            linkBandwidths = splitList(arg.substr(10));
+        } else if (arg.rfind("--cache=", 0) == 0) {
+            caches = splitList(arg.substr(8));
+        } else if (arg.rfind("--topology=", 0) == 0) {
+            topologies = splitList(arg.substr(11));
+        } else if (arg.rfind("--jobs=", 0) == 0) {
+            try {
+                jobs = unsigned(std::max(1, std::stoi(arg.substr(7))));
+            } catch (...) {
+                std::cerr << "Error: Valor numérico inválido en la opción " << arg << "\n";
+                return 1;
+            }
+        } else if (arg.rfind("--out=", 0) == 0) {
+            outDir = arg.substr(6);
+        } else if (arg.rfind("--mem-file=", 0) == 0 || arg.rfind("--checkpoint", 0) == 0) {
+            std::cerr << "Error: " << arg.substr(0, arg.find('=')) << " no aplica a un barrido (todas las instancias "
+                      << "usarían el mismo archivo).\n";
+            return 1;
+        } else if (arg.rfind("--run=", 0) == 0 || arg.rfind("--break-", 0) == 0 || arg == "--verbose" ||
+                   arg.rfind("--workers=", 0) == 0) {
+            std::cerr << "Error: " << arg << " no aplica a un barrido (cada instancia corre en batch, en silencio y en un hilo).\n";
+            return 1;
+        } else if (!parseSimulationOption(arg, base, error)) {
+            std::cerr << "Error: " << error << "\n";
+            return 1;
+        }
+    }
+    if (peCounts.empty()) peCounts = {std::to_string(base.numPEs)};
+    if (linkBandwidths.empty()) linkBandwidths = {std::to_string(base.topologyConfig.linkBytesPerCycle)};
+    if (topologies.empty()) topologies = {topologyName(base.topologyConfig.type)};
+    if (caches.empty()) {
+        caches = {std::to_string(base.cacheConfig.sizeBytes) + "x" + std::to_string(base.cacheConfig.associativity) +
+                  "x" + std::to_string(base.cacheConfig.lineSize)};
+    }
+
+    // Producto cartesiano de los ejes
+    std::vector<SweepPoint> points;
+    for (const std::string& mode : modes)
+    for (const std::string& workload : workloads)
+    for (const std::string& pes : peCounts)
+    for (const std::string& bandwidth : linkBandwidths)
+    for (const std::string& cache : caches)
+    for (const std::string& topology : topologies) {
+        SweepPoint point;
+        point.config = base;
+        SimulationConfig& config = point.config;
+        try {
+            config.arbiterMode = std::stoi(mode);
+        } catch (...) {
+            config.arbiterMode = -1;
+        }
+        if (config.arbiterMode < 0 || config.arbiterMode > 4) {
+            std::cerr << "Error: Modo de ejecución inválido: " << mode << " (0 a 4).\n";
+            return 1;
+        }
+        if (parseTrafficPattern(workload, config.workload.pattern)) {
+            config.synthetic = true;
+        } else if (workload == "1" || workload == "2") {
+            config.testNumber = std::stoi(workload);
+        } else {
+            std::cerr << "Error: Workload inválido: " << workload << " (1|2 o un patrón sintético).\n";
+            return 1;
+        }
+        if (!parseCacheGeometry(cache, config.cacheConfig)) {
+            std::cerr << "Error: Geometría de caché inválida: " << cache << " (BYTESxVÍASxLÍNEA).\n";
+            return 1;
+        }
+        if (!applyAxis("--pes=", pes, config) || !applyAxis("--link-bw=", bandwidth, config) ||
+            !applyAxis("--topology=", topology, config)) {
+            return 1;
+        }
+        std::string configError = simulationConfigError(config);
+        if (!configError.empty()) {
+            std::cerr << "Error: " << configError << "\n";
+            return 1;
+        }
+
+        point.name = "m" + mode + "_" + (config.synthetic ? workload : "test" + workload) + "_p" + pes + "_bw" +
+                     bandwidth + "_c" + cache + "_" + topology;
+        config.outputDir = outDir + "/" + point.name;
+        points.push_back(std::move(point));
+    }
+
+    jobs = std::min<unsigned>(jobs, unsigned(points.size()));
+    std::cout << "<< Barrido de " << points.size() << " simulaciones en " << jobs << " hilo(s), salida en "
+              << outDir << " >>\n";
+
+    // Cada hilo toma el siguiente punto libre; las instancias no comparten estado
+    std::vector<SweepResult> results(points.size());
+    std::atomic<size_t> next{0};
+    std::atomic<size_t> done{0};
+    std::mutex progressMutex;
+    std::vector<std::thread> workers;
+    for (unsigned j = 0; j < jobs; ++j) {
+        workers.emplace_back([&] {
+            for (size_t i = next.fetch_add(1); i < points.size(); i = next.fetch_add(1)) {
+                results[i] = runPoint(points[i]);
+                std::lock_guard<std::mutex> lock(progressMutex);
+                std::cout << "<< [" << ++done << "/" << points.size() << "] " << points[i].name
+                          << (results[i].ok ? "" : " (error)") << " >>\n";
+            }
+        });
+    }
+    for (auto& worker : workers) worker.join();
+
+    // Tabla de resultados: CSV completo y resumen en consola
+    std::string csvPath = outDir + "/results.csv";
+    std::ofstream csv(csvPath);
+    if (!csv) {
+        std::cerr << "Error: No se pudo escribir " << csvPath << "\n";
+        return 1;
+    }
+    csv << "name,mode,workload,pes,link_bw,cache,topology,status,cycles,events,transactions,utilization,"
+        << "latency_mean,latency_p50,latency_p95,latency_p99,traffic_bytes,memory_reads,memory_writes,"
+        << "invalidations,hit_rate,wall_ms\n";
+    for (size_t i = 0; i < points.size(); ++i) writeRow(csv, points[i], results[i]);
+
+    std::cout << std::left << std::setw(48) << "instancia" << std::right << std::setw(10) << "ciclos"
+              << std::setw(8) << "util%" << std::setw(10) << "lat.media" << std::setw(8) << "p99"
+              << std::setw(12) << "bytes" << std::setw(8) << "hit%" << std::setw(10) << "ms" << "\n";
+    bool allOk = true;
+    for (size_t i = 0; i < points.size(); ++i) {
+        const SweepResult& result = results[i];
+        std::cout << std::left << std::setw(48) << points[i].name << std::right;
+        if (!result.ok) {
+            std::cout << "  error\n";
+            allOk = false;
+            continue;
+        }
+        std::cout << std::fixed << std::setprecision(1) << std::setw(10) << result.cycles << std::setw(8)
+                  << result.utilization << std::setw(10) << result.latencyMean << std::setw(8) << result.latencyP99
+                  << std::setw(12) << result.trafficBytes << std::setw(8) << 100.0 * result.hitRate
+                  << std::setw(10) << result.wallMs << "\n";
+    }
+    std::cout << "<< Resultados en " << csvPath << " >>\n";
+    return allOk ? 0 : 1;
+}
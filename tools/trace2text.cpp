@@ -0,0 +1,67 @@
+// Convierte trazas binarias (.bin) al formato de texto original (.txt).
+// Uso:
+//   trace2text <archivo.bin> [salida.txt]  → convierte un archivo (por defecto, mismo nombre con .txt)
+//   trace2text <carpeta>                   → convierte todos los .bin de la carpeta (ej: ../output)
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include "TraceReader.hpp"
+
+namespace {
+
+constexpr size_t FLUSH_BYTES = 1 << 20;
+
+bool convert(const std::filesystem::path& input, const std::filesystem::path& output) {
+    TraceReader reader;
+    if (!reader.open(input.string())) {
+        std::cerr << "Error: " << reader.error() << "\n";
+        return false;
+    }
+    std::FILE* file = std::fopen(output.string().c_str(), "wb");
+    if (!file) {
+        std::cerr << "Error: No se pudo crear " << output.string() << "\n";
+        return false;
+    }
+
+    std::string text = TRACE_TEXT_HEADER;
+    for (const TraceRecord& rec : reader) {
+        appendTraceLine(text, rec);
+        if (text.size() >= FLUSH_BYTES) {
+            std::fwrite(text.data(), 1, text.size(), file);
+            text.clear();
+        }
+    }
+    std::fwrite(text.data(), 1, text.size(), file);
+    std::fclose(file);
+
+    std::cout << input.string() << " → " << output.string() << " (" << reader.size() << " registros)\n";
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 2 || argc > 3) {
+        std::cerr << "Uso: " << argv[0] << " <archivo.bin|carpeta> [salida.txt]\n";
+        return 1;
+    }
+
+    std::filesystem::path input = argv[1];
+    if (std::filesystem::is_directory(input)) {
+        if (argc == 3) {
+            std::cerr << "Error: Con una carpeta no se indica archivo de salida.\n";
+            return 1;
+        }
+        bool ok = true;
+        for (const auto& entry : std::filesystem::directory_iterator(input)) {
+            if (entry.path().extension() != ".bin") continue;
+            std::filesystem::path output = entry.path();
+            ok &= convert(entry.path(), output.replace_extension(".txt"));
+        }
+        return ok ? 0 : 1;
+    }
+
+    std::filesystem::path output = argc == 3 ? std::filesystem::path(argv[2]) : std::filesystem::path(input).replace_extension(".txt");
+    return convert(input, output) ? 0 : 1;
+}